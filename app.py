@@ -48,6 +48,7 @@ def main():
     plan = solver.get_solution()
     print(f"Number of paths : {plan.size()}")
     print(f"Makespan : {plan.get_makespan()}")
+    print(f"Shape of states : {plan.states().shape}")
     print(f"No Conflicts? : {plan.validate(instance)}")
     plan.save("app.plan")
     elapsed = (time.time() - t_start) * 1000
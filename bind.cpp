@@ -2,58 +2,145 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
-#include <pybind11/embed.h>
 
-#include "logger.h"
-#include "graph.h"
-#include "problem.h"
-#include "solver.h"
+#include "mapf.h"
+#include "planio.h"
+#include "batch.h"
+#include "portfolio.h"
 #include "pibt.h"
+#include "lacam.h"
+#include "lns.h"
+#include "pp.h"
+#include "tswap.h"
+#include "adg.h"
+#include "traffic.h"
 
 
-struct Parameters {
-    bool verbose = true;
-    bool log = false;
-    std::string map = "";
-    bool with_weights = true;
-    std::string solver = "";
-    int seed = 42;
-    int max_timestep = 10000;       // maximum number of discrete steps
-    int max_comp_time = 1000;       // maximum computation time limit (ms)
-};
-
-void setLogger(bool enabled, bool log){
-    Logger::get().setVerbose(enabled);
-    if (log) {
-        Logger::get().enableFileLogging("output.log");
-    } else {
-        Logger::get().disableFileLogging();
+namespace py = pybind11;
+using StateArray = py::array_t<int32_t, py::array::c_style | py::array::forcecast>;
+
+StateArray config_to_array(const Grid* G, const Config& config) {
+    // (N, 3) rows of x, y, orientation; -1 for absent agents
+    StateArray arr({(py::ssize_t)config.size(), (py::ssize_t)3});
+    auto out = arr.mutable_unchecked<2>();
+    for (py::ssize_t i = 0; i < (py::ssize_t)config.size(); ++i) {
+        if (config[i].empty()) {
+            out(i, 0) = out(i, 1) = out(i, 2) = -1;
+            continue;
+        }
+        State s = G->getState(config[i]);
+        out(i, 0) = s.node->pos.x;
+        out(i, 1) = s.node->pos.y;
+        out(i, 2) = s.orientation;
     }
+    return arr;
 }
 
-Grid* make_graph(const Parameters& params) {
-    setLogger(params.verbose, params.log);
-    Grid *G = new Grid(params.map, params.with_weights);
-    return G;
+Config array_to_config(const Grid* G, const StateArray& arr, int num_agents, bool allow_empty = false) {
+    if (arr.ndim() != 2 || arr.shape(1) != 3) throw std::runtime_error("States must be of shape (N, 3)");
+    if (arr.shape(0) != num_agents) throw std::runtime_error("Mismatch between states and number of agents");
+    auto in = arr.unchecked<2>();
+    Config config;
+    config.reserve(num_agents);
+    for (py::ssize_t i = 0; i < arr.shape(0); ++i) {
+        int x = in(i, 0), y = in(i, 1), orientation = in(i, 2);
+        if (allow_empty && x == -1 && y == -1) {
+            config.emplace_back();
+            continue;
+        }
+        if (!G->existNode(x, y)) throw std::runtime_error("State outside of free cells");
+        if (!(-1 <= orientation && orientation < 4)) throw std::runtime_error("Invalid orientation");     // -1 for omnidirectional agents
+        config.emplace_back(G->getNode(x, y), orientation);
+    }
+    return config;
 }
 
-MAPF_Instance* make_instance(Grid* G, const Parameters& params) {
-    std::mt19937* MT = new std::mt19937(42);
-    MAPF_Instance* P = new MAPF_Instance(G, MT, params.max_timestep, params.max_comp_time);
-    return P;
-}
 
-MAPF_Solver* make_solver(MAPF_Instance* P, const Parameters& params) {
-    if (params.solver == "PIBT") {
-        MAPF_Solver* solver = new PIBT(P);
-        return solver;
+template <typename Motion>
+void bind_pibt(py::module_& m, const char* name) {
+    auto reset_goal = [](PIBT<Motion>& self, int i, int x, int y, int orientation) {
+        const Grid* G = self.getP()->getG();
+        if (!G->existNode(x, y)) throw std::runtime_error("State outside of free cells");
+        self.resetGoal(i, State(G->getNode(x, y), orientation));
+    };
+    py::class_<PIBT<Motion>, MAPF_Solver> cls(m, name);
+    // goal headings are required for oriented agents, omnidirectional ones have none
+    if constexpr (std::is_same_v<Motion, Oriented>) {
+        cls.def("reset_goal", reset_goal, py::arg("i"), py::arg("x"), py::arg("y"), py::arg("orientation"));
+    } else {
+        cls.def("reset_goal", reset_goal, py::arg("i"), py::arg("x"), py::arg("y"), py::arg("orientation") = -1);
     }
-    throw std::runtime_error("Unknown solver selected");
+    cls
+        .def_property_readonly("timestep", &PIBT<Motion>::getTimestep)
+        .def_property_readonly("last_step_time", &PIBT<Motion>::getLastStepTime)
+        .def_property_readonly("max_step_time", &PIBT<Motion>::getMaxStepTime)
+        .def_property("step_budget", &PIBT<Motion>::getStepBudget, &PIBT<Motion>::setStepBudget)
+        .def_property_readonly("overruns", &PIBT<Motion>::getOverruns)
+        .def("init", &PIBT<Motion>::init, py::call_guard<py::gil_scoped_release>())
+        .def("step", [](PIBT<Motion>& self, py::object observed) {
+            // observed: optional (N, 3) states, rows of -1 keep the planned state
+            Config config;
+            if (observed.is_none()) {
+                py::gil_scoped_release release;
+                config = self.step();
+            } else {
+                Config obs = array_to_config(self.getP()->getG(), observed.cast<StateArray>(), self.getP()->getNum(), true);
+                py::gil_scoped_release release;
+                config = self.step(obs);
+            }
+            return config_to_array(self.getP()->getG(), config);
+        }, py::arg("observed") = py::none())
+        .def_property("recording", &PIBT<Motion>::isRecording, &PIBT<Motion>::setRecording)
+        .def_property("num_threads", &PIBT<Motion>::getNumThreads, &PIBT<Motion>::setNumThreads)
+        .def_property("tile_size", &PIBT<Motion>::getTileSize, &PIBT<Motion>::setTileSize)
+        .def("get_config", [](const PIBT<Motion>& self) {
+            return config_to_array(self.getP()->getG(), self.getConfig());
+        })
+        .def("plan_window", &PIBT<Motion>::planWindow, py::arg("horizon"), py::arg("commit"),
+            py::call_guard<py::gil_scoped_release>())
+        .def("refresh_distances", &PIBT<Motion>::refreshDistances, py::call_guard<py::gil_scoped_release>())
+        .def("replan", &PIBT<Motion>::replan, py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("tasks_completed", &PIBT<Motion>::getTasksCompleted)
+        .def_property_readonly("throughput", &PIBT<Motion>::getThroughput)
+        .def("set_goal_provider", [](PIBT<Motion>& self, py::function fn) {
+            // fn(agent, timestep) -> (x, y, orientation), or None when the agent has no further task
+            const Grid* G = self.getP()->getG();
+            self.setGoalProvider([fn, G](int i, int t, State& goal) {
+                py::gil_scoped_acquire gil;
+                py::object result = fn(i, t);
+                if (result.is_none()) return false;
+                auto [x, y, orientation] = result.cast<std::tuple<int, int, int>>();
+                if (!G->existNode(x, y)) throw std::runtime_error("Goal outside of free cells");
+                goal = State(G->getNode(x, y), orientation);
+                return true;
+            });
+        }, py::arg("provider"))
+        .def("set_goal_queue", [](PIBT<Motion>& self, GoalQueue& queue) {
+            self.setGoalProvider(queue.provider());
+        }, py::arg("queue"), py::keep_alive<1, 2>());
 }
 
-namespace py = pybind11;
+template <typename Motion>
+void bind_guidance(py::module_& m, const char* name) {
+    py::class_<GuidanceOptimizer<Motion>>(m, name)
+        .def(py::init([](Grid* G, int num_agents, const StateArray& tasks, int horizon, uint64_t seed) {
+            // tasks as (K, 3) rows of x, y, orientation, issued in order
+            std::vector<State> goals;
+            for (auto& p : array_to_config(G, tasks, (int)tasks.shape(0))) goals.push_back(G->getState(p));
+            return new GuidanceOptimizer<Motion>(G, num_agents, goals, horizon, seed);
+        }), py::arg("graph"), py::arg("num_agents"), py::arg("tasks"), py::arg("horizon"), py::arg("seed") = 0, py::keep_alive<1, 2>())
+        .def_property("contra_flow_penalty", &GuidanceOptimizer<Motion>::getContraFlowPenalty, &GuidanceOptimizer<Motion>::setContraFlowPenalty)
+        .def_property("congestion_penalty", &GuidanceOptimizer<Motion>::getCongestionPenalty, &GuidanceOptimizer<Motion>::setCongestionPenalty)
+        .def_property("max_weight", &GuidanceOptimizer<Motion>::getMaxWeight, &GuidanceOptimizer<Motion>::setMaxWeight)
+        .def("evaluate", &GuidanceOptimizer<Motion>::evaluate, py::call_guard<py::gil_scoped_release>())
+        .def("optimize", &GuidanceOptimizer<Motion>::optimize, py::arg("iterations"), py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("best_throughput", &GuidanceOptimizer<Motion>::getBestThroughput)
+        .def_property_readonly("history", &GuidanceOptimizer<Motion>::getHistory);
+}
 
 PYBIND11_MODULE(mapf, m) {
+    py::register_exception<MAPFError>(m, "MAPFError", PyExc_RuntimeError);
+
     py::class_<Parameters>(m, "Parameters", py::dynamic_attr())
         .def(py::init<>())
         .def_readwrite("verbose", &Parameters::verbose)
@@ -63,7 +150,16 @@ PYBIND11_MODULE(mapf, m) {
         .def_readwrite("solver", &Parameters::solver)
         .def_readwrite("seed", &Parameters::seed)
         .def_readwrite("max_timestep", &Parameters::max_timestep)
-        .def_readwrite("max_comp_time", &Parameters::max_comp_time);
+        .def_readwrite("max_comp_time", &Parameters::max_comp_time)
+        .def_readwrite("stall_window", &Parameters::stall_window)
+        .def_readwrite("max_recoveries", &Parameters::max_recoveries)
+        .def_readwrite("num_threads", &Parameters::num_threads)
+        .def_readwrite("tile_size", &Parameters::tile_size)
+        .def_readwrite("portfolio_size", &Parameters::portfolio_size)
+        .def_readwrite("portfolio_mode", &Parameters::portfolio_mode)
+        .def_readwrite("pp_max_restarts", &Parameters::pp_max_restarts)
+        .def_readwrite("lns_initial", &Parameters::lns_initial)
+        .def_readwrite("lns_neighborhood_size", &Parameters::lns_neighborhood_size);
 
     py::class_<Grid>(m, "Graph")
         .def("weights", [](const Grid& self) {
@@ -76,7 +172,8 @@ PYBIND11_MODULE(mapf, m) {
             float* data_ptr = static_cast<float*>(info.ptr);
             std::vector<float> vec(data_ptr, data_ptr + info.size);
             self.setWeights(vec);
-        }, py::arg("arr"));
+        }, py::arg("arr"))
+        .def("save_weights", &Grid::saveWeights, py::arg("filename"));
 
     py::class_<Plan>(m, "Plan")
         .def(py::init<>())
@@ -86,18 +183,61 @@ PYBIND11_MODULE(mapf, m) {
         .def("save", [](Plan& self, const std::string& filename = "output.plan") {
             self.save(filename);
         }, py::arg("filename"))
+        .def("save_binary", [](Plan& self, const std::string& filename, int block_size) {
+            self.saveBinary(filename, block_size);
+        }, py::arg("filename"), py::arg("block_size") = 256)
         .def("validate", [](Plan& self, MAPF_Instance* P) {
             return self.validate(P);
-        }, py::arg("instance"))
+        }, py::arg("instance"), py::call_guard<py::gil_scoped_release>())
+        .def("states", [](const Plan& self) {
+            // (T, N, 3) rows of x, y, orientation; -1 once an agent has left
+            py::ssize_t T = self.empty() ? 0 : self.getMakespan() + 1;
+            StateArray arr({T, (py::ssize_t)self.size(), (py::ssize_t)3});
+            int32_t* out = arr.mutable_data();
+            py::gil_scoped_release release;
+            self.exportStates(out);
+            return arr;
+        })
+        .def("path_lengths", [](const Plan& self) {
+            py::array_t<int32_t> arr(self.size());
+            auto out = arr.mutable_unchecked<1>();
+            for (int i = 0; i < self.size(); ++i) out(i) = self.getPathLength(i);
+            return arr;
+        })
         .def("get_path", [](Plan& self, int i) {
             Path path = self.getPath(i);
             std::vector<std::tuple<int, int, int>> arr;
-            for (auto& s : path) {
-                arr.emplace_back(s.node->pos.x, s.node->pos.y, s.orientation);
+            for (auto& p : path) {
+                State s = self.getG()->getState(p);
+                if (s.node == nullptr) arr.emplace_back(-1, -1, -1);       // agent absent
+                else arr.emplace_back(s.node->pos.x, s.node->pos.y, s.orientation);
             }
             return arr;
         }, py::arg("i"));
 
+    py::class_<PlanReader>(m, "PlanFile")
+        .def(py::init<const std::string&>(), py::arg("filename"))
+        .def_property_readonly("num_agents", &PlanReader::size)
+        .def_property_readonly("makespan", &PlanReader::getMakespan)
+        .def_property_readonly("map_hash", &PlanReader::getMapHash)
+        .def("get_state", [](const PlanReader& self, const Grid* G, int t, int i) {
+            self.checkMap(G);
+            State s = G->getState(self.get(t, i));
+            if (s.node == nullptr) return py::object(py::none());
+            return py::object(py::make_tuple(s.node->pos.x, s.node->pos.y, s.orientation));
+        }, py::arg("graph"), py::arg("t"), py::arg("i"))
+        .def("get_path", [](const PlanReader& self, const Grid* G, int i) {
+            self.checkMap(G);
+            std::vector<std::tuple<int, int, int>> arr;
+            for (auto& p : self.getPath(i)) {
+                State s = G->getState(p);
+                if (s.node == nullptr) arr.emplace_back(-1, -1, -1);       // agent absent
+                else arr.emplace_back(s.node->pos.x, s.node->pos.y, s.orientation);
+            }
+            return arr;
+        }, py::arg("graph"), py::arg("i"))
+        .def("to_plan", &PlanReader::toPlan, py::arg("graph"), py::keep_alive<0, 2>());
+
     py::class_<MAPF_Instance>(m, "Instance")
         .def_property_readonly("name", [](const MAPF_Instance& self) {
             return self.getInstanceFileName();
@@ -106,51 +246,199 @@ PYBIND11_MODULE(mapf, m) {
             return self.getNum();
         })
         .def("get_starts", [](const MAPF_Instance& self) {
-            Config config_s = self.getConfigStart();
-            std::vector<std::tuple<int, int, int>> start;
-            for (auto& s : config_s) {
-                start.emplace_back(s.node->pos.x, s.node->pos.y, s.orientation);
-            }
-            return start;
+            return config_to_array(self.getG(), self.getConfigStart());
         })
         .def("get_goals", [](const MAPF_Instance& self) {
-            Config config_g = self.getConfigGoal();
-            std::vector<std::tuple<int, int, int>> goal;
-            for (auto& s : config_g) {
-                goal.emplace_back(s.node->pos.x, s.node->pos.y, s.orientation);
-            }
-            return goal;
+            return config_to_array(self.getG(), self.getConfigGoal());
         })
-        .def("make", py::overload_cast<int> (&MAPF_Instance::make))
-        .def("make", [](MAPF_Instance& self,
-            const std::vector<std::tuple<int, int, int>>& start,
-            const std::vector<std::tuple<int, int, int>>& goal,
-            int num_agents) {
-                assert(start.size() == num_agents);
-                assert(goal.size() == num_agents);
-                Config config_s;
-                int x, y, orientation;
-                for (auto& s : start) {
-                    std::tie(x, y, orientation) = s;
-                    assert(0 <= orientation && orientation < 4);
-                    config_s.emplace_back(self.getG()->getNode(x, y), orientation);
-                }
-                Config config_g;
-                for (auto& s : goal) {
-                    std::tie(x, y, orientation) = s;
-                    assert(0 <= orientation && orientation < 4);
-                    config_g.emplace_back(self.getG()->getNode(x, y), orientation);
-                }
-                return self.make(config_s, config_g, num_agents);
-            }, py::arg("start"), py::arg("goal"), py::arg("num_agents"));
+        .def("make", py::overload_cast<int> (&MAPF_Instance::make), py::call_guard<py::gil_scoped_release>())
+        .def("make", [](MAPF_Instance& self, const StateArray& start, const StateArray& goal, int num_agents) {
+            // accepts (N, 3) arrays as well as sequences of (x, y, orientation)
+            Config config_s = array_to_config(self.getG(), start, num_agents);
+            Config config_g = array_to_config(self.getG(), goal, num_agents);
+            return self.make(config_s, config_g, num_agents);
+        }, py::arg("start"), py::arg("goal"), py::arg("num_agents"))
+        .def("set_start", [](MAPF_Instance& self, int i, int x, int y, int orientation) {
+            const Grid* G = self.getG();
+            if (!G->existNode(x, y)) throw std::runtime_error("State outside of free cells");
+            self.setStart(i, State(G->getNode(x, y), orientation));
+        }, py::arg("i"), py::arg("x"), py::arg("y"), py::arg("orientation") = -1)
+        .def("set_goal", [](MAPF_Instance& self, int i, int x, int y, int orientation) {
+            const Grid* G = self.getG();
+            if (!G->existNode(x, y)) throw std::runtime_error("State outside of free cells");
+            self.setGoal(i, State(G->getNode(x, y), orientation));
+        }, py::arg("i"), py::arg("x"), py::arg("y"), py::arg("orientation") = -1);
     
     py::class_<MAPF_Solver>(m, "MAPF_Solver")
         .def_property_readonly("name", [](const MAPF_Solver& self) {
             return self.getSolverName();
         })
-        .def("solve", &MAPF_Solver::solve)
+        .def("solve", &MAPF_Solver::solve, py::call_guard<py::gil_scoped_release>())
+        .def("create_distance_table", &MAPF_Solver::createDistanceTable, py::call_guard<py::gil_scoped_release>())
         .def("succeed", &MAPF_Solver::succeed)
-        .def("get_solution", &MAPF_Solver::getSolution);
+        .def("get_solution", &MAPF_Solver::getSolution, py::return_value_policy::reference_internal)
+        .def("distance", [](const MAPF_Solver& self, int i, int x, int y) {
+            if (!(0 <= i && i < (int)self.getDistanceTable().size())) throw std::out_of_range("Invalid agent index");
+            if (!(0 <= x && x < self.getP()->getG()->getWidth() && 0 <= y && y < self.getP()->getG()->getHeight())) {
+                throw std::out_of_range("Invalid cell");
+            }
+            return self.getDistanceTable()[i][y * self.getP()->getG()->getWidth() + x];
+        }, py::arg("i"), py::arg("x"), py::arg("y"))
+        .def("distance_row", [](const MAPF_Solver& self, int i) {
+            // (H, W) view of the distances of agent i; the array keeps the table it
+            // points into alive, later updates of the solver copy instead of writing
+            if (!(0 <= i && i < (int)self.getDistanceTable().size())) throw std::out_of_range("Invalid agent index");
+            const Grid* G = self.getP()->getG();
+            auto table = new std::shared_ptr<MAPF_Solver::DistanceTable>(self.getSharedDistanceTable());
+            py::capsule base(table, [](void* p) {
+                delete static_cast<std::shared_ptr<MAPF_Solver::DistanceTable>*>(p);
+            });
+            py::array_t<int> arr({(py::ssize_t)G->getHeight(), (py::ssize_t)G->getWidth()}, (**table)[i].data(), base);
+            arr.attr("flags").attr("writeable") = false;
+            return arr;
+        }, py::arg("i"))
+        .def("stream_solution", &MAPF_Solver::streamSolution, py::arg("filename"), py::arg("block_size") = 256)
+        .def("request_stop", &MAPF_Solver::requestStop);
+
+    py::class_<GoalQueue>(m, "GoalQueue")
+        .def(py::init<>())
+        .def("push", [](GoalQueue& self, const Grid* G, int x, int y, int orientation) {
+            if (!G->existNode(x, y)) throw std::runtime_error("Goal outside of free cells");
+            self.push(State(G->getNode(x, y), orientation));
+        }, py::arg("graph"), py::arg("x"), py::arg("y"), py::arg("orientation"))
+        .def("__len__", &GoalQueue::size);
+
+    bind_pibt<Omnidirectional>(m, "PIBTOmnidirectional");
+    bind_pibt<Oriented>(m, "PIBT");
+
+    py::class_<Portfolio, MAPF_Solver>(m, "Portfolio")
+        .def_property_readonly("size", &Portfolio::size)
+        .def_property_readonly("winner", &Portfolio::getWinner)
+        .def("member_solution", [](const Portfolio& self, int k) -> const Plan& {
+            return self.getMember(k)->getSolution();
+        }, py::arg("k"), py::return_value_policy::reference_internal);
+
+    py::class_<LaCAM<Oriented>, MAPF_Solver>(m, "LaCAM")
+        .def_property_readonly("explored", &LaCAM<Oriented>::getNumExplored)
+        .def_property_readonly("generated", &LaCAM<Oriented>::getNumGenerated);
+    py::class_<LaCAM<Omnidirectional>, MAPF_Solver>(m, "LaCAMOmnidirectional")
+        .def_property_readonly("explored", &LaCAM<Omnidirectional>::getNumExplored)
+        .def_property_readonly("generated", &LaCAM<Omnidirectional>::getNumGenerated);
+    py::class_<PrioritizedPlanning<Oriented>, MAPF_Solver>(m, "PrioritizedPlanning")
+        .def_property("hold_window", &PrioritizedPlanning<Oriented>::getHoldWindow, &PrioritizedPlanning<Oriented>::setHoldWindow)
+        .def_property("max_restarts", &PrioritizedPlanning<Oriented>::getMaxRestarts, &PrioritizedPlanning<Oriented>::setMaxRestarts)
+        .def_property_readonly("restarts", &PrioritizedPlanning<Oriented>::getNumRestarts)
+        .def_property_readonly("expanded", &PrioritizedPlanning<Oriented>::getNumExpanded)
+        .def_property_readonly("order", &PrioritizedPlanning<Oriented>::getOrder);
+    py::class_<PrioritizedPlanning<Omnidirectional>, MAPF_Solver>(m, "PrioritizedPlanningOmnidirectional")
+        .def_property("hold_window", &PrioritizedPlanning<Omnidirectional>::getHoldWindow, &PrioritizedPlanning<Omnidirectional>::setHoldWindow)
+        .def_property("max_restarts", &PrioritizedPlanning<Omnidirectional>::getMaxRestarts, &PrioritizedPlanning<Omnidirectional>::setMaxRestarts)
+        .def_property_readonly("restarts", &PrioritizedPlanning<Omnidirectional>::getNumRestarts)
+        .def_property_readonly("expanded", &PrioritizedPlanning<Omnidirectional>::getNumExpanded)
+        .def_property_readonly("order", &PrioritizedPlanning<Omnidirectional>::getOrder);
+    py::class_<TSWAP<Oriented>, MAPF_Solver>(m, "TSWAP")
+        .def_property_readonly("assignment", &TSWAP<Oriented>::getAssignment)
+        .def_property_readonly("assigned_goals", &TSWAP<Oriented>::getAssignedGoals)
+        .def_property_readonly("swaps", &TSWAP<Oriented>::getNumSwaps);
+    py::class_<TSWAP<Omnidirectional>, MAPF_Solver>(m, "TSWAPOmnidirectional")
+        .def_property_readonly("assignment", &TSWAP<Omnidirectional>::getAssignment)
+        .def_property_readonly("assigned_goals", &TSWAP<Omnidirectional>::getAssignedGoals)
+        .def_property_readonly("swaps", &TSWAP<Omnidirectional>::getNumSwaps);
+    py::class_<LNS<Oriented>, MAPF_Solver>(m, "LNS")
+        .def_property("neighborhood_size", &LNS<Oriented>::getNeighborhoodSize, &LNS<Oriented>::setNeighborhoodSize)
+        .def_property_readonly("iterations", &LNS<Oriented>::getIterations)
+        .def_property_readonly("timeline", &LNS<Oriented>::getTimeline);
+    py::class_<LNS<Omnidirectional>, MAPF_Solver>(m, "LNSOmnidirectional")
+        .def_property("neighborhood_size", &LNS<Omnidirectional>::getNeighborhoodSize, &LNS<Omnidirectional>::setNeighborhoodSize)
+        .def_property_readonly("iterations", &LNS<Omnidirectional>::getIterations)
+        .def_property_readonly("timeline", &LNS<Omnidirectional>::getTimeline);
+
+    py::class_<ActionDependencyGraph>(m, "ActionDependencyGraph")
+        .def(py::init<const Plan&>(), py::arg("plan"), py::keep_alive<1, 2>())
+        .def("__len__", &ActionDependencyGraph::size)
+        .def_property_readonly("num_actions", py::overload_cast<>(&ActionDependencyGraph::getNumActions, py::const_))
+        .def_property_readonly("num_edges", &ActionDependencyGraph::getNumEdges)
+        .def_property_readonly("replans", &ActionDependencyGraph::getNumReplans)
+        .def_property("delay_tolerance", &ActionDependencyGraph::getDelayTolerance, &ActionDependencyGraph::setDelayTolerance)
+        .def("release", [](ActionDependencyGraph& self) {
+            // (agent, action, (x, y, orientation) from, to, rotation or -1)
+            static const char* names[] = {"wait", "move", "turn_left", "turn_right", "none"};
+            auto tuple = [&](const PackedState& p) {
+                State s = self.getG()->getState(p);
+                return py::make_tuple(s.node->pos.x, s.node->pos.y, s.orientation);
+            };
+            py::list commands;
+            for (auto& c : self.release()) {
+                commands.append(py::make_tuple(c.agent, names[static_cast<int>(c.action)], tuple(c.from), tuple(c.to), c.rotation));
+            }
+            return commands;
+        })
+        .def("report_completion", &ActionDependencyGraph::reportCompletion, py::arg("i"))
+        .def("report_delay", &ActionDependencyGraph::reportDelay, py::arg("i"), py::arg("steps"))
+        .def("finished", py::overload_cast<>(&ActionDependencyGraph::finished, py::const_))
+        .def_property_readonly("blocked_agents", &ActionDependencyGraph::getBlockedAgents)
+        .def("replan", [](ActionDependencyGraph& self, int max_timestep) {
+            // pick instantiation for motion model of the plan
+            switch (self.getMotionModel()) {
+                case MotionModel::OMNIDIRECTIONAL : return self.replan<Omnidirectional>(max_timestep);
+                case MotionModel::ORIENTED : return self.replan<Oriented>(max_timestep);
+                default : break;
+            }
+            throw std::runtime_error("Agents with and without heading cannot be mixed");
+        }, py::arg("max_timestep") = 10000);
+
+    bind_guidance<Omnidirectional>(m, "GuidanceOptimizerOmnidirectional");
+    bind_guidance<Oriented>(m, "GuidanceOptimizer");
+
+    py::class_<InstanceSpec>(m, "InstanceSpec")
+        .def(py::init([](uint64_t seed, int num_agents, bool keep_plan) {
+            InstanceSpec spec;
+            spec.seed = seed;
+            spec.num_agents = num_agents;
+            spec.keep_plan = keep_plan;
+            return spec;
+        }), py::arg("seed") = 42, py::arg("num_agents") = 0, py::arg("keep_plan") = false)
+        .def_readwrite("seed", &InstanceSpec::seed)
+        .def_readwrite("num_agents", &InstanceSpec::num_agents)
+        .def_readwrite("keep_plan", &InstanceSpec::keep_plan)
+        .def("set_states", [](InstanceSpec& self, const Grid* G, const StateArray& start, const StateArray& goal) {
+            int n = start.ndim() == 2 ? (int)start.shape(0) : 0;
+            self.starts = array_to_config(G, start, n);
+            self.goals = array_to_config(G, goal, n);
+            self.num_agents = n;
+        }, py::arg("graph"), py::arg("start"), py::arg("goal"));
+
+    m.attr("BATCH_COLUMNS") = py::make_tuple("solved", "makespan", "soc", "lb_makespan", "lb_soc", "comp_time", "precomp_time");
+    m.def("solve_batch", [](py::object graph, const Parameters& params, const InstanceSpecs& specs, int num_threads) {
+        // returns metrics table (one row per spec, columns as BATCH_COLUMNS), errors (empty unless failed) and kept plans
+        BatchSolver batch(graph.cast<Grid*>(), params, num_threads);
+        // plans refer to the graph, so the copies keep it alive
+        py::cpp_function copy_plan([](const Grid*, const Plan& plan) {
+            return Plan(plan);
+        }, py::keep_alive<0, 1>());
+        {
+            py::gil_scoped_release release;
+            batch.solve(specs);
+        }
+        const BatchResults& results = batch.getResults();
+        py::array_t<int64_t> table({(py::ssize_t)results.size(), (py::ssize_t)7});
+        auto out = table.mutable_unchecked<2>();
+        py::list errors;
+        py::list plans;
+        for (py::ssize_t k = 0; k < (py::ssize_t)results.size(); ++k) {
+            const BatchResult& r = results[k];
+            int64_t row[] = {r.solved, r.makespan, r.soc, r.lb_makespan, r.lb_soc, r.comp_time, r.precomp_time};
+            for (int c = 0; c < 7; ++c) out(k, c) = row[c];
+            errors.append(r.error);
+            const Plan* plan = batch.getPlan(k);
+            if (plan == nullptr) {
+                plans.append(py::none());
+                continue;
+            }
+            plans.append(copy_plan(graph, py::cast(plan, py::return_value_policy::reference)));
+        }
+        return py::make_tuple(table, errors, plans);
+    }, py::arg("graph"), py::arg("params"), py::arg("specs"), py::arg("num_threads") = 0);
 
     m.def("make_graph", [](const Parameters& params) {
         return std::unique_ptr<Grid>(make_graph(params));
@@ -158,9 +446,9 @@ PYBIND11_MODULE(mapf, m) {
 
     m.def("make_instance", [](Grid* G, const Parameters& params) {
         return std::unique_ptr<MAPF_Instance>(make_instance(G, params));
-    }, py::arg("graph"), py::arg("params"));
+    }, py::arg("graph"), py::arg("params"), py::keep_alive<0, 1>());
 
     m.def("make_solver", [](MAPF_Instance* P, const Parameters& params) {
         return std::unique_ptr<MAPF_Solver>(make_solver(P, params));
-    }, py::arg("instance"), py::arg("params"));
+    }, py::arg("instance"), py::arg("params"), py::keep_alive<0, 1>());
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include "logger.h"
+#include "motion.h"
+#include "plan.h"
+
+
+// execution of a plan on robots that run late: the plan becomes a temporal
+// action dependency graph, per-agent action sequences without waits plus
+// edges ordering the agents through each shared cell, and commands are
+// released as soon as their dependencies completed instead of on the clock
+class ActionDependencyGraph {
+    public:
+        struct Command {
+            int agent;
+            int index;              // in the action sequence of the agent
+            Action action;
+            PackedState from;
+            PackedState to;
+            int t;                  // planned timestep of the action
+            int rotation;           // commands of a rotation run together, -1 if none
+        };
+
+    private:
+        struct Vertex {
+            Command command;
+            std::vector<std::pair<int, int>> dependencies;    // (agent, index) leaving the cell before
+            std::vector<std::pair<int, int>> dependents;      // (agent, index) entering the cell after
+            int unmet;              // dependencies not completed yet
+        };
+
+        const Grid* G;
+        std::vector<std::vector<Vertex>> actions;   // per agent, in order
+        std::vector<std::vector<std::pair<int, int>>> rotations;     // agents moving in a cycle in one timestep
+        std::vector<PackedState> starts;            // initial state of each agent, empty if absent
+        std::vector<int> completed;                 // completed actions of each agent
+        std::vector<bool> released;                 // next action of each agent was released
+        std::vector<int> delays;                    // reported delay of the current action (steps)
+        int delay_tolerance;                        // delay before dependents are considered blocked
+        int num_edges;
+        int num_replans;
+
+        void build(const std::vector<Path>& paths);
+        std::vector<Path> schedule() const;         // earliest timing of the remaining actions from now
+        bool blocked(const int i, std::vector<int>& memo) const;
+
+    protected:
+        LOGGER(ActionDependencyGraph);
+
+    public:
+        ActionDependencyGraph(const Plan& plan);
+        ~ActionDependencyGraph() {}
+
+        const Grid* getG() const {return G;}
+        int size() const {return (int)actions.size();}
+        int getNumActions() const;
+        int getNumActions(const int i) const {return (int)actions[i].size();}
+        int getNumCompleted(const int i) const {return completed[i];}
+        int getNumEdges() const {return num_edges;}
+        int getNumReplans() const {return num_replans;}
+        int getDelayTolerance() const {return delay_tolerance;}
+        void setDelayTolerance(const int d) {delay_tolerance = d;}
+        bool finished() const;
+        bool finished(const int i) const {return completed[i] == (int)actions[i].size();}
+        PackedState getState(const int i) const;        // after the completed actions, empty once left
+        MotionModel getMotionModel() const;             // from the headings of the planned states
+
+        // execution: release commands, then report progress and delays of robots;
+        // commands of one rotation are released together and must run in lockstep
+        std::vector<Command> release();
+        void reportCompletion(const int i);             // the released action of agent i is done
+        void reportDelay(const int i, const int steps); // the current action of agent i runs late
+        int getDelay(const int i) const {return delays[i];}
+
+        // agents waiting, directly or not, on an agent late beyond the tolerance
+        bool isBlocked() const {return !getBlockedAgents().empty();}
+        std::vector<int> getBlockedAgents() const;
+
+        // replans the blocked agents around the others, which keep their remaining
+        // actions; the late agents hold their cells for their delays. The graph is
+        // rebuilt from the current states, which resets the reported delays;
+        // false if a blocked agent found no path. Motion must match getMotionModel()
+        template <typename Motion>
+        bool replan(const int max_timestep);
+};
+
+extern template bool ActionDependencyGraph::replan<Omnidirectional>(const int max_timestep);
+extern template bool ActionDependencyGraph::replan<Oriented>(const int max_timestep);
@@ -0,0 +1,50 @@
+#pragma once
+#include "logger.h"
+#include "mapf.h"
+
+
+// one instance of a batch; random starts and goals unless both configs are given
+struct InstanceSpec {
+    uint64_t seed = 42;
+    int num_agents = 0;
+    Config starts;
+    Config goals;
+    bool keep_plan = false;
+};
+using InstanceSpecs = std::vector<InstanceSpec>;
+
+struct BatchResult {
+    bool solved = false;
+    int makespan = 0;
+    int soc = 0;
+    int lb_makespan = 0;
+    int lb_soc = 0;
+    int comp_time = 0;          // ms, including precomputation
+    int precomp_time = 0;       // ms
+    std::string error;          // empty unless the instance failed
+};
+using BatchResults = std::vector<BatchResult>;
+
+// solves independent instances on one graph concurrently
+class BatchSolver {
+    private:
+        Grid* const G;          // shared, read-only while solving
+        const Parameters params;
+        int num_threads;
+        BatchResults results;
+        std::vector<std::unique_ptr<Plan>> plans;   // nullptr unless kept
+
+        void solveOne(const InstanceSpec& spec, BatchResult& result, std::unique_ptr<Plan>& plan) const;
+
+    protected:
+        LOGGER(BatchSolver);
+
+    public:
+        BatchSolver(Grid* G, const Parameters& params, int num_threads = 0);
+        ~BatchSolver() {}
+
+        void solve(const InstanceSpecs& specs);
+        const BatchResults& getResults() const {return results;}
+        const Plan* getPlan(const int k) const {return plans.at(k).get();}
+        int getNumThreads() const {return num_threads;}
+};
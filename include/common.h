@@ -2,26 +2,32 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <climits>
 #include <cmath>
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <numeric>
 #include <queue>
 #include <random>
 #include <regex>
+#include <stdexcept>
 #include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "rng.h"
 
 constexpr int MAX_WEIGHT = INT_MAX / 2;
 using Time = std::chrono::steady_clock;
@@ -38,14 +44,26 @@ inline bool inArray(const T* a, const std::vector<T*>& arr) {
     return itr != arr.end();
 }
 
-inline int getRandomInt(int min, int max, std::mt19937& MT) {
-    std::uniform_int_distribution<int> r(min, max);
-    return r(MT);
+inline int getRandomInt(int min, int max, RNG& rng) {
+    // unbiased and identical on every platform, unlike std distributions
+    uint64_t range = (uint64_t)((int64_t)max - min) + 1;
+    uint64_t limit = UINT64_MAX - UINT64_MAX % range;
+    uint64_t x;
+    do {x = rng();} while (x >= limit);
+    return (int)(min + (int64_t)(x % range));
 }
 
-inline float getRandomFloat(float min, float max, std::mt19937& MT) {
-    std::uniform_real_distribution<float> r(min, max);
-    return r(MT);
+inline float getRandomFloat(float min, float max, RNG& rng) {
+    float u = (rng() >> 40) * (1.f / 16777216.f);      // [0, 1) from 24 bits
+    return min + (max - min) * u;
+}
+
+template <typename Iter>
+inline void randomShuffle(Iter first, Iter last, RNG& rng) {
+    // fisher-yates
+    for (int i = (int)(last - first) - 1; i > 0; --i) {
+        std::swap(first[i], first[getRandomInt(0, i, rng)]);
+    }
 }
 
 inline auto getElapsedTime(const Time::time_point& t) {
@@ -105,10 +105,52 @@ struct State {
     }
 };
 
-using Path = std::vector<State>;
+// compact state handle, node id * 4 + heading, used in configs, paths and plans
+struct PackedState {
+    static constexpr uint32_t NONE = UINT32_MAX;    // agent does not exist
+    static constexpr uint32_t OMNI = 1u << 31;      // agent without heading
+
+    uint32_t code;
+
+    PackedState() : code(NONE) {}
+    PackedState(Node* node, int orientation = -1) :
+        code(node == nullptr ? NONE : pack(node->id, orientation)) {}
+    PackedState(const State& s) : PackedState(s.node, s.orientation) {}
+
+    static constexpr uint32_t pack(int id, int orientation) {
+        return (orientation == -1) ? (((uint32_t)id << 2) | OMNI) : (((uint32_t)id << 2) | (uint32_t)orientation);
+    }
+    static PackedState fromCode(uint32_t code) {
+        PackedState s; s.code = code;
+        return s;
+    }
+
+    bool empty() const {return code == NONE;}
+    int id() const {return (int)((code & ~OMNI) >> 2);}
+    int orientation() const {return (code & OMNI) ? -1 : (int)(code & 3);}
+    int index() const {return (int)(code & ~OMNI);}     // dense index in [0, 4 * |V|)
+
+    struct Hasher {
+        size_t operator()(const PackedState& s) const {
+            return std::hash<uint32_t>()(s.code);
+        }
+    };
+
+    friend bool operator==(const PackedState& a, const PackedState& b) {
+        return a.code == b.code;
+    }
+
+    friend bool operator!=(const PackedState& a, const PackedState& b) {
+        return a.code != b.code;
+    }
+};
+static_assert(sizeof(PackedState) == 4, "PackedState must stay 32-bit");
+
+using Path = std::vector<PackedState>;
 std::ostream& operator<<(std::ostream& os, const Pos& pos);
 std::ostream& operator<<(std::ostream& os, const Node& node);
 std::ostream& operator<<(std::ostream& os, const State& state);
+std::ostream& operator<<(std::ostream& os, const PackedState& state);
 
 class Grid {
     private:
@@ -120,6 +162,9 @@ class Grid {
         Nodes V;
         std::vector<float> weights;
 
+        template <typename Motion>
+        std::pair<Path, float> searchPath(const State& s, const State& g, RNG* rng, const Nodes& prohibited) const;
+
     protected:
         LOGGER(Grid);
 
@@ -133,7 +178,9 @@ class Grid {
         int getChannels() const {return channels;}
         const std::vector<float>& getWeights() const {return weights;}
         void setWeights(const std::vector<float>& weights);
+        void saveWeights(const std::string& filename) const;       // same format as the .weights file
         int size() const {return height * width;}
+        uint64_t getHash() const;       // fingerprint of dimensions and free cells
 
         float getWeight(int x, int y, int ch) const;
         float getWeight(Node* const u, int ch) const;
@@ -145,5 +192,8 @@ class Grid {
         bool existNode(int x, int y) const;
         Node* getNode(int id) const {return V[id];}
         Node* getNode(int x, int y) const {return getNode(y * width + x);}
-        std::pair<Path, float> getPathWithCost(const State& s, const State& g, std::mt19937* MT = nullptr, const Nodes& prohibited = {}) const;
+        State getState(const PackedState& s) const {
+            return s.empty() ? State() : State(V[s.id()], s.orientation());
+        }
+        std::pair<Path, float> getPathWithCost(const State& s, const State& g, RNG* rng = nullptr, const Nodes& prohibited = {}) const;
 };
@@ -0,0 +1,73 @@
+#pragma once
+#include "logger.h"
+#include "monitor.h"
+#include "solver.h"
+
+
+// lazy search over configurations with PIBT as successor generator (LaCAM);
+// complete for omnidirectional agents, unlike PIBT alone
+template <typename Motion>
+class LaCAM : public MAPF_Solver {
+    private:
+        // low-level node: next node of one agent, on top of the constraints of its parent
+        struct Constraint {
+            const Constraint* parent;   // nullptr at the root
+            int who;                    // -1 at the root
+            Node* where;
+            int depth;          // number of agents constrained so far, in order of the high-level node
+        };
+
+        // high-level node: a configuration reached by the search
+        struct HNode {
+            Config C;
+            HNode* parent;
+            int depth;                          // number of steps from start
+            std::vector<float> priorities;
+            std::vector<int> order;             // agents by descending priority
+            std::queue<Constraint*> tree;       // constraints not yet tried
+        };
+
+        struct ConfigHasher {
+            size_t operator()(const Config& config) const {return ProgressMonitor::hash(config);}
+        };
+
+        std::deque<HNode> nodes;                // owns high-level nodes
+        std::deque<Constraint> constraints;     // owns low-level nodes
+        std::unordered_map<Config, HNode*, ConfigHasher> explored;
+        int generated;      // configurations generated, keys the random streams
+        int num_explored;   // distinct configurations of the last search
+
+        // configuration generator
+        std::vector<int> occupied_now;      // agent per node, -1 if empty
+        std::vector<int> occupied_next;
+        Nodes next;                         // next node of each agent
+        std::vector<int> moving;            // resolution of moves, see advances()
+
+        HNode* createNode(const Config& C, HNode* parent);
+        Constraint* createConstraint(Constraint* parent, int i, Node* v);
+        bool funcPIBT(const Config& C, int i, int j = -1);
+        bool advances(int i);
+        bool generate(HNode* H, const Constraint* L, Config& Q);
+        void backtrack(HNode* H);
+        void run();
+
+    protected:
+        LOGGER(LaCAM);
+
+    public:
+        LaCAM(MAPF_Instance* P) :
+            MAPF_Solver(P),
+            generated(0),
+            num_explored(0),
+            occupied_now(G->size(), -1),
+            occupied_next(G->size(), -1) {
+                solver_name = "LaCAM";
+            }
+        ~LaCAM() {}
+
+        int getNumExplored() const {return num_explored;}
+        int getNumGenerated() const {return generated;}
+};
+
+extern template class LaCAM<Omnidirectional>;
+extern template class LaCAM<Oriented>;
@@ -0,0 +1,23 @@
+#pragma once
+#include "logger.h"
+#include "graph.h"
+
+
+// issues the next goal of an agent arriving at its goal; false if it has no further task
+using GoalProvider = std::function<bool(int agent, int timestep, State& goal)>;
+
+// first-come first-served task queue shared by all agents
+class GoalQueue {
+    private:
+        mutable std::mutex mtx;
+        std::deque<State> goals;
+
+    public:
+        GoalQueue() {}
+        ~GoalQueue() {}
+
+        void push(const State& goal);
+        bool pop(State& goal);
+        size_t size() const;
+        GoalProvider provider();        // valid while the queue lives
+};
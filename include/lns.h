@@ -0,0 +1,46 @@
+#pragma once
+#include "logger.h"
+#include "reservation.h"
+#include "solver.h"
+
+
+// anytime refinement of an initial solution by large neighborhood search:
+// agent subsets are replanned against the rest until the time limit
+template <typename Motion>
+class LNS : public MAPF_Solver {
+    public:
+        enum class Neighborhood {RANDOM, CONGESTION, BLOCKING};
+
+    private:
+        std::unique_ptr<MAPF_Solver> initial;       // provides the first solution, PIBT by default
+        std::vector<Path> paths;                    // until each agent leaves at its goal
+        DistanceTable steps;                        // fewest steps to goal, admissible heuristic of the search
+        ReservationTable table;
+        int neighborhood_size;
+        std::array<float, 3> weights;               // adaptive selection of neighborhoods
+        int iterations;
+        int lower_bound;                            // sum of fewest steps, stops the refinement
+        std::vector<std::pair<int, int>> timeline;  // (elapsed ms, soc) at every improvement
+
+        bool findPath(const int i, Path& path);
+        std::vector<int> selectNeighborhood(Neighborhood type, RNG& rng);
+        void run();
+
+    protected:
+        LOGGER(LNS);
+
+    public:
+        LNS(MAPF_Instance* P);
+        ~LNS() {}
+
+        void setInitialSolver(std::unique_ptr<MAPF_Solver> solver);
+        const MAPF_Solver* getInitialSolver() const {return initial.get();}
+        int getNeighborhoodSize() const {return neighborhood_size;}
+        void setNeighborhoodSize(const int k) {neighborhood_size = k;}
+        int getIterations() const {return iterations;}
+        int getLowerBound() const {return lower_bound;}
+        const std::vector<std::pair<int, int>>& getTimeline() const {return timeline;}
+};
+
+extern template class LNS<Omnidirectional>;
+extern template class LNS<Oriented>;
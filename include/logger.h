@@ -4,9 +4,15 @@
 
 enum class LogLevel {DEBUG, INFO, WARN, ERROR};
 
+// raised by error(); leaves the process and other solvers untouched
+class MAPFError : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+};
+
 class Logger {
     private:
-        bool verbose;
+        std::atomic<bool> verbose;
         bool fileLogging;
         std::ofstream logFile;
         std::mutex mtx;
@@ -32,7 +38,7 @@ class Logger {
             std::string output = "[" + levelToStr(lvl) + "] " + name + " : ";
             output += msg + "\n";
 
-            if (verbose || lvl == LogLevel::ERROR) {
+            if (verbose) {
                 std::cout << output;
                 std::cout.flush();
             }
@@ -40,7 +46,6 @@ class Logger {
                 logFile << output;
                 logFile.flush();
             }
-            if (lvl == LogLevel::ERROR) std::exit(1);
         }
 
     public:
@@ -66,14 +71,16 @@ class Logger {
         }
 
         void log(LogLevel lvl, const std::string& name, const std::string& msg) {
-            std::lock_guard<std::mutex> lock(mtx);
-            write(lvl, name, msg);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                write(lvl, name, msg);
+            }
+            if (lvl == LogLevel::ERROR) throw MAPFError(name + " : " + msg);
         }
 
         void log(LogLevel lvl, const std::string& name, const std::string& msg, const Time::time_point& t) {
-            std::lock_guard<std::mutex> lock(mtx);
             int elapsed = getElapsedTime(t);
-            write(lvl, name, msg + " (" + std::to_string(elapsed) + " ms)");
+            log(lvl, name, msg + " (" + std::to_string(elapsed) + " ms)");
         }
 };
 
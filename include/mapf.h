@@ -0,0 +1,31 @@
+#pragma once
+#include "logger.h"
+#include "graph.h"
+#include "problem.h"
+#include "solver.h"
+
+
+struct Parameters {
+    bool verbose = true;
+    bool log = false;
+    std::string map = "";
+    bool with_weights = true;
+    std::string solver = "";        // PIBT, LACAM, PP, TSWAP, LNS or PORTFOLIO
+    int seed = 42;
+    int max_timestep = 10000;       // maximum number of discrete steps
+    int max_comp_time = 1000;       // maximum computation time limit (ms)
+    int stall_window = 0;           // steps without progress before livelock is declared (0: automatic)
+    int max_recoveries = 3;         // recovery attempts before terminating early
+    int num_threads = 1;            // workers of parallel PIBT steps (0: all hardware threads)
+    int tile_size = 32;             // side of the tiles planned concurrently by PIBT
+    int portfolio_size = 4;         // concurrent configurations of the portfolio solver
+    std::string portfolio_mode = "first";       // first, soc or makespan
+    int pp_max_restarts = 10;                   // restarts of prioritized planning after a failed agent
+    std::string lns_initial = "PIBT";           // solver of the solution refined by LNS
+    int lns_neighborhood_size = 8;              // agents replanned per LNS iteration
+};
+
+void setLogger(bool enabled, bool log);
+Grid* make_graph(const Parameters& params);
+MAPF_Instance* make_instance(Grid* G, const Parameters& params);
+MAPF_Solver* make_solver(MAPF_Instance* P, const Parameters& params);
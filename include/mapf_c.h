@@ -0,0 +1,62 @@
+#pragma once
+/* Stable C interface to libmapf.
+ * Objects are opaque handles owned by the caller and released with the
+ * matching destroy function; an instance must outlive its solvers and a
+ * graph its instances. Functions returning int report MAPF_OK or
+ * MAPF_ERROR, with the message of the last error on the calling thread
+ * available from mapf_last_error(). States are rows of (x, y, orientation),
+ * orientation -1 for agents without heading. */
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define MAPF_API __declspec(dllexport)
+#else
+#define MAPF_API __attribute__((visibility("default")))
+#endif
+
+#define MAPF_C_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mapf_graph mapf_graph;
+typedef struct mapf_instance mapf_instance;
+typedef struct mapf_solver mapf_solver;
+
+enum mapf_status {MAPF_OK = 0, MAPF_ERROR = -1};
+
+MAPF_API int mapf_api_version(void);
+MAPF_API const char* mapf_last_error(void);
+MAPF_API void mapf_set_verbose(int enabled);
+
+/* graph loaded from <map>.map, and <map>.weights if with_weights */
+MAPF_API mapf_graph* mapf_graph_create(const char* map, int with_weights);
+MAPF_API void mapf_graph_destroy(mapf_graph* graph);
+MAPF_API int mapf_graph_width(const mapf_graph* graph);
+MAPF_API int mapf_graph_height(const mapf_graph* graph);
+
+MAPF_API mapf_instance* mapf_instance_create(mapf_graph* graph, uint64_t seed, int max_timestep, int max_comp_time);
+MAPF_API void mapf_instance_destroy(mapf_instance* instance);
+MAPF_API int mapf_instance_make_random(mapf_instance* instance, int num_agents);
+/* starts and goals hold num_agents x 3 values */
+MAPF_API int mapf_instance_make(mapf_instance* instance, const int32_t* starts, const int32_t* goals, int num_agents);
+MAPF_API int mapf_instance_num_agents(const mapf_instance* instance);
+
+/* solver by name, e.g. "PIBT" */
+MAPF_API mapf_solver* mapf_solver_create(mapf_instance* instance, const char* name);
+MAPF_API void mapf_solver_destroy(mapf_solver* solver);
+MAPF_API int mapf_solver_solve(mapf_solver* solver);
+MAPF_API int mapf_solver_succeeded(const mapf_solver* solver);
+MAPF_API int mapf_solver_comp_time(const mapf_solver* solver);
+
+/* solution of the last solve; T = makespan + 1 timesteps */
+MAPF_API int mapf_plan_makespan(const mapf_solver* solver);
+MAPF_API int mapf_plan_path_length(const mapf_solver* solver, int agent);
+/* writes T x N x 3 values, absent agents as -1; capacity counts int32 values */
+MAPF_API int mapf_plan_states(const mapf_solver* solver, int32_t* out, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
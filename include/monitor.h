@@ -0,0 +1,33 @@
+#pragma once
+#include "logger.h"
+#include "problem.h"
+
+
+class ProgressMonitor {
+    private:
+        int window;                         // number of steps tolerated without progress
+        std::vector<int> best_dist;         // best distance-to-goal reached by each agent
+        std::vector<int> last_improved;     // timestep at which each agent last improved
+        int last_progress;                  // timestep at which any agent last improved
+        std::deque<size_t> history;         // hashes of recent configurations
+        std::unordered_map<size_t, int> counts;
+
+    protected:
+        LOGGER(ProgressMonitor);
+
+    public:
+        ProgressMonitor(int num_agents, int window);
+        ~ProgressMonitor() {}
+
+        int getWindow() const {return window;}
+        int getLastProgress() const {return last_progress;}
+        int countDistinct() const {return (int)counts.size();}      // distinct configurations within window
+
+        void reset(int timestep);
+        void retarget(int i, int timestep);             // agent i received a new goal
+        void observe(int i, int d, int timestep);       // distance-to-goal of agent i
+        void record(const Config& config);
+        bool stalled(int timestep) const;
+        std::vector<int> getStalledAgents(int timestep) const;
+        static size_t hash(const Config& config);
+};
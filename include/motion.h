@@ -0,0 +1,112 @@
+#pragma once
+#include "graph.h"
+
+
+enum class Action {WAIT, MOVE, TURN_LEFT, TURN_RIGHT, NONE};
+using Actions = std::vector<Action>;
+
+// agent motion models, selected at compile time so that the inner loops of
+// neighbor generation, PIBT and validation compile without heading switches
+struct Heading {
+    // heading h moves by (DX[h], DY[h]); 0 : +y, 1 : -x, 2 : -y, 3 : +x
+    static constexpr std::array<int, 4> DX = {0, -1, 0, 1};
+    static constexpr std::array<int, 4> DY = {1, 0, -1, 0};
+    static constexpr std::array<int, 4> LEFT = {1, 2, 3, 0};
+    static constexpr std::array<int, 4> RIGHT = {3, 0, 1, 2};
+    // rotation towards target heading given (target - h + 4) % 4
+    static constexpr std::array<Action, 4> ROTATE = {
+        Action::WAIT, Action::TURN_LEFT, Action::TURN_LEFT, Action::TURN_RIGHT
+    };
+
+    // heading of a unit move by (dx, dy), -1 otherwise
+    static constexpr int of(int dx, int dy) {
+        return (dx == 0 && dy == 1) ? 0 :
+            (dx == -1 && dy == 0) ? 1 :
+            (dx == 0 && dy == -1) ? 2 :
+            (dx == 1 && dy == 0) ? 3 : -1;
+    }
+};
+
+// agents move to any neighbor without turning; orientation is always -1
+struct Omnidirectional {
+    static constexpr const char* name = "omnidirectional";
+
+    static bool isValidOrientation(int orientation) {return orientation == -1;}
+
+    static int getNeighbor(const Grid&, const State& s, std::array<State, 4>& buf) {
+        int cnt = 0;
+        for (auto v : s.node->neighbor) buf[cnt++] = State(v);
+        return cnt;
+    }
+
+    static Node* forward(const Grid&, const State&) {
+        return nullptr;
+    }
+
+    static Action getAction(const State& curr, Node* const next, const State&) {
+        return (next == curr.node) ? Action::WAIT : Action::MOVE;
+    }
+
+    // nullptr when transition is valid, otherwise the reason
+    static const char* checkTransition(const State& prev, const State& curr) {
+        if (prev.node == curr.node) {
+            if (prev.orientation != curr.orientation) return "Agent made an invalid rotation";
+            return nullptr;
+        }
+        if (!inArray(curr.node, prev.node->neighbor)) return "Agent made an invalid transition";
+        if (curr.orientation != -1) return "Agent made an invalid move with rotation";
+        return nullptr;
+    }
+};
+
+// agents move forward along their heading, or turn in place by 90 degrees
+struct Oriented {
+    static constexpr const char* name = "oriented";
+
+    static bool isValidOrientation(int orientation) {return 0 <= orientation && orientation < 4;}
+
+    static int getNeighbor(const Grid& G, const State& s, std::array<State, 4>& buf) {
+        int cnt = 0;
+        Node* v = forward(G, s);
+        if (v != nullptr) buf[cnt++] = State(v, s.orientation);
+        buf[cnt++] = State(s.node, Heading::LEFT[s.orientation]);
+        buf[cnt++] = State(s.node, Heading::RIGHT[s.orientation]);
+        return cnt;
+    }
+
+    static Node* forward(const Grid& G, const State& s) {
+        int x = s.node->pos.x + Heading::DX[s.orientation];
+        int y = s.node->pos.y + Heading::DY[s.orientation];
+        return G.existNode(x, y) ? G.getNode(x, y) : nullptr;
+    }
+
+    static Action getAction(const State& curr, Node* const next, const State& goal) {
+        int target = curr.orientation;
+        if (next == curr.node) {
+            if (next != goal.node) return Action::WAIT;
+            target = goal.orientation;      // agent is at goal, rotate to face target orientation
+        } else {
+            target = Heading::of(next->pos.x - curr.node->pos.x, next->pos.y - curr.node->pos.y);
+            if (target == -1) return Action::NONE;
+            if (target == curr.orientation) return Action::MOVE;
+        }
+        return Heading::ROTATE[(target - curr.orientation + 4) % 4];
+    }
+
+    static const char* checkTransition(const State& prev, const State& curr) {
+        if (curr.orientation < 0 || curr.orientation > 3) return "Unknown agent orientation";
+        if (prev.node == curr.node) {
+            int dtheta = (curr.orientation - prev.orientation + 4) % 4;
+            if (dtheta == 2) return "Agent made an invalid rotation";
+            return nullptr;
+        }
+        if (prev.orientation != curr.orientation) return "Agent made an invalid move with rotation";
+        if (curr.node->pos.x - prev.node->pos.x != Heading::DX[prev.orientation] ||
+            curr.node->pos.y - prev.node->pos.y != Heading::DY[prev.orientation]) {
+            return "Agent made an invalid move";
+        }
+        return nullptr;
+    }
+};
+
+enum class MotionModel {OMNIDIRECTIONAL, ORIENTED, MIXED};
@@ -1,11 +1,12 @@
 #pragma once
 #include "logger.h"
+#include "monitor.h"
 #include "solver.h"
+#include "lifelong.h"
+#include "workers.h"
 
 
-enum class Action {WAIT, MOVE, TURN_LEFT, TURN_RIGHT, NONE};
-using Actions = std::vector<Action>;
-
+template <typename Motion>
 class PIBT : public MAPF_Solver {
     private:
         struct Agent {
@@ -17,20 +18,79 @@ class PIBT : public MAPF_Solver {
             int init_dist;  // distance from start to goal
             float epsilon;
             bool done;
+            bool idle;      // lifelong: goal reached and no next task yet, stays on its node
         };
         using Agents = std::vector<Agent*>;
+        enum class Status {RUNNING, SOLVED, STALLED};
+
+        // search state between two timesteps, for rolling back a lookahead
+        struct Snapshot {
+            std::vector<Agent> pool;
+            Agents A;
+            ProgressMonitor monitor;
+            int timestep;
+            int recoveries;
+            int tasks_completed;
+            bool solved;
+            bool resort;
+        };
 
+        std::vector<Agent> pool;    // owns agents, indexed by id
+        Agents A;                   // agents sorted by priority
         Agents occupied_now;    // current locations
         Agents occupied_next;   // next locations
         bool distance_initialized;
+        bool initialized;       // agents are placed and ready to step
+        bool resort;            // priorities changed since last step
+        int timestep;           // current timestep, keys the random streams
+        int stall_window;       // steps without progress before livelock is declared
+        int max_recoveries;     // recovery attempts before terminating early
+        int recoveries;
+        ProgressMonitor monitor;
+        GoalProvider goal_provider;     // lifelong mode when set
+        bool lookahead;         // planning beyond the committed steps of a window
+        bool recording;         // append planned configs to the solution
+        int tasks_completed;    // goals reached since initialization
+        int last_step_time;     // latency of the last step (us)
+        int max_step_time;      // worst step latency since initialization (us)
+        int step_budget;        // latency bound of a step (us), 0 for none
+        int overruns;           // steps over the budget since initialization
+        uint64_t revision;      // instance revision the agents reflect
+        int num_threads;        // workers planning tiles concurrently, 1 for serial steps
+        std::unique_ptr<WorkerPool> workers;    // started by setNumThreads, woken once per step
+        int tile_size;          // side of square tiles in cells
+        std::vector<int> tile_of;           // tile of each node
+        std::vector<bool> interior;         // node and its neighbors in one tile
+        struct Tile {
+            Agents agents;          // on interior nodes, in priority order
+            Agents planned;         // by the current call, undone on escalation
+            bool escalated;         // the call reached an unplanned border agent
+        };
+        std::vector<Tile> tiles;
 
-        bool funcPIBT(Agent* a, Agent* b = nullptr);
+        static bool comparePriority(Agent* const a, Agent* const b);
+        bool funcPIBT(Agent* a, Agent* b = nullptr, Tile* tile = nullptr);
+        void partition();
+        void planTiles();
         Action getAction(const State& curr, Node* const next, const State& goal) const;
+        void initAgents();
+        Status update(Config& config);
+        Status updateOnline(Config& config);
+        Snapshot save() const;
+        void restore(const Snapshot& snapshot);
+        std::string describeStall(const std::vector<int>& stalled) const;
+        void synchronize(const Config& observed);
+        void retarget(Agent* a, const State& goal);
+        void applyChanges();
+        void search();
         void run();
 
         void wait(Agent* a, Config& config);
         void turn(Agent* a, const Actions& actions, Config& config);
-        bool move(Agent* a, const Actions& actions, Config& config);
+        void advance(Agent* a, Config& config);
+        void rotate(const Agents& cycle, Config& config);
+        void resolve(const Agents& A, const Actions& actions, Config& config);
+        void recover(Agents& A, const std::vector<int>& stalled);
 
     protected:
         LOGGER(PIBT);
@@ -40,8 +100,68 @@ class PIBT : public MAPF_Solver {
             MAPF_Solver(P),
             occupied_now(Agents(G->size(), nullptr)),
             occupied_next(Agents(G->size(), nullptr)),
-            distance_initialized(false) {
+            distance_initialized(false),
+            initialized(false),
+            resort(false),
+            timestep(0),
+            stall_window(2 * (G->getWidth() + G->getHeight())),
+            max_recoveries(3),
+            recoveries(0),
+            monitor(P->getNum(), stall_window),
+            lookahead(false),
+            recording(true),
+            tasks_completed(0),
+            last_step_time(0),
+            max_step_time(0),
+            step_budget(0),
+            overruns(0),
+            revision(0),
+            num_threads(1),
+            tile_size(32) {
                 solver_name = "PIBT";
             }
         ~PIBT() {}
+
+        int getStallWindow() const {return stall_window;}
+        int getMaxRecoveries() const {return max_recoveries;}
+        void setStallWindow(const int w) {stall_window = w;}
+        void setMaxRecoveries(const int n) {max_recoveries = n;}
+
+        // parallel steps: agents inside tiles are planned concurrently, agents
+        // on tile borders afterwards in priority order
+        int getNumThreads() const {return num_threads;}
+        void setNumThreads(const int n);        // 0 for all hardware threads
+        int getTileSize() const {return tile_size;}
+        void setTileSize(const int w);
+
+        // online use: init() once, then one step() per control cycle
+        void init();
+        Config step();
+        Config step(const Config& observed);        // continue from observed states, empty to keep planned
+        void resetGoal(const int i, const State& goal);
+        Config getConfig() const;       // current configuration
+        void refreshDistances();        // after changes of weights
+        // warm start after P->setStart/setGoal: keeps priorities, occupancy and the solution so far
+        void replan();
+
+        // rolling horizon: plan horizon steps ahead, advance by the first commit steps
+        Plan planWindow(const int horizon, const int commit);
+        bool isRecording() const {return recording;}
+        void setRecording(const bool enabled) {recording = enabled;}     // off to bound memory of long runs
+        bool isInitialized() const {return initialized;}
+        int getTimestep() const {return timestep;}
+        int getLastStepTime() const {return last_step_time;}
+        int getMaxStepTime() const {return max_step_time;}
+        int getStepBudget() const {return step_budget;}
+        void setStepBudget(const int us) {step_budget = us;}     // steps over it are counted and reported
+        int getOverruns() const {return overruns;}
+
+        // lifelong use: agents arriving at their goal ask the provider for the next one
+        void setGoalProvider(GoalProvider provider) {goal_provider = std::move(provider);}
+        bool isLifelong() const {return (bool)goal_provider;}
+        int getTasksCompleted() const {return tasks_completed;}
+        float getThroughput() const;        // tasks completed per 1,000 steps
 };
+
+extern template class PIBT<Omnidirectional>;
+extern template class PIBT<Oriented>;
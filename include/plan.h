@@ -3,37 +3,113 @@
 #include "problem.h"
 
 
+enum class ConflictType {START, GOAL, TRANSITION, VERTEX, EDGE};
+
+struct Conflict {
+    ConflictType type;
+    int t;                  // timestep
+    int i;                  // agent
+    int j;                  // other agent, -1 if none
+    const char* reason;     // for invalid transitions
+};
+using Conflicts = std::vector<Conflict>;
+class PlanWriter;
+std::ostream& operator<<(std::ostream& os, const Conflict& c);
+
 struct Plan {
     private:
-        Configs configs;
+        // per-agent action stream; 3-bit symbols relative to the previous state,
+        // with periodic checkpoints for random access
+        enum Symbol : uint8_t {WAIT, TURN_LEFT, TURN_RIGHT, JUMP, MOVE};     // MOVE + heading of move
+        struct Track {
+            static constexpr int PER_WORD = 21;         // symbols per 64-bit word
+            static constexpr int CHECKPOINT = 64;       // symbols between checkpoints
+
+            std::vector<uint64_t> words;
+            std::vector<PackedState> jumps;             // target states of JUMP symbols
+            std::vector<std::pair<PackedState, int>> checkpoints;     // state and number of jumps so far
+            int symbols = 0;            // number of stored symbols
+            int pending = 0;            // trailing waits not yet stored
+            PackedState last;           // most recent state
+            PackedState tail;           // most recent state while present
+            int end = -1;               // first timestep without agent since it was last present, -1 if present
+            std::vector<std::pair<int, PackedState>> departures;     // timestep of leaving and state left
+
+            uint8_t symbol(int k) const {
+                return (words[k / PER_WORD] >> (3 * (k % PER_WORD))) & 7;
+            }
+        };
+
+        const Grid* G;      // graph to resolve packed states
+        int width;          // grid width, to decode moves
+        int length;         // number of configurations
+        std::vector<Track> tracks;
+        std::string stream_file;                // binary file receiving added configs, empty if none
+        int stream_block_size;
+        std::shared_ptr<PlanWriter> writer;     // opened with the first added config
 
         Config get(const int t) const;
-        State get(const int t, const int i) const;
+        PackedState get(const int t, const int i) const;
         Config getLast() const;
 
-        bool sameConfig(const Config& a, const Config& b) const;
-        bool validate(const Config& start, const Config& goal) const;
+        uint8_t encode(const PackedState& p, const PackedState& q) const;
+        PackedState decode(const PackedState& p, uint8_t symbol, const Track& track, int& jump) const;
+        void push(Track& track, uint8_t symbol);
+        void append(Track& track, const PackedState& q, int t);
+        PackedState departure(const int i, const int t) const;
+
+        template <typename Motion>
+        void findConflicts(const Grid* G, int t_begin, int t_end, Conflicts& conflicts) const;
 
     protected:
         LOGGER(Plan);
 
     public:
+        // sequential access to the states of one agent
+        class Reader {
+            private:
+                const Plan* plan;
+                const Track* track;
+                int k;              // index of next symbol
+                int jump;           // index of next jump target
+                PackedState state;
+
+            public:
+                Reader(const Plan* plan, int i, int t);
+                PackedState get() const {return state;}
+                void next();
+        };
+
+        Plan(const Grid* G = nullptr) :
+            G(G),
+            width(G == nullptr ? 0 : G->getWidth()),
+            length(0),
+            stream_block_size(256) {}
         ~Plan() {}
 
-        bool empty() const {return configs.empty();}
-        int size() const {
-            if (configs.empty()) return 0;
-            return (int)configs.at(0).size();
-        }
+        const Grid* getG() const {return G;}
+        bool empty() const {return length == 0;}
+        int size() const {return (int)tracks.size();}
         int getMakespan() const {
-            if (configs.empty()) return 0;
-            return (int)configs.size() - 1;
+            if (length == 0) return 0;
+            return length - 1;
         }
+        int getSOC() const;         // sum of steps until each agent leaves
+        size_t getMemoryUsage() const;
         void save(const std::string& filename = "output.plan") const;
+        void saveBinary(const std::string& filename, int block_size = 256) const;
+        void stream(const std::string& filename, int block_size = 256);
+        void closeStream();         // raises if the streamed file is incomplete
+        void clear() {length = 0; tracks.clear();}      // drop all configs, a requested stream stays
 
         void add(const Config& c);
-        Path getPath(const int i) const;
-        bool validate(MAPF_Instance* P) const;
+        void assign(const Plan& other);         // copy the configs of another plan, a requested stream stays
+        Reader getReader(const int i, const int t = 0) const;
+        Path getPath(const int i) const;        // until the agent last leaves, empty states while absent
+        int getPathLength(const int i) const;
+        void exportStates(int32_t* out) const;      // length x size x (x, y, orientation), -1 if absent
+        Conflicts findConflicts(MAPF_Instance* P, int num_threads = 0) const;
+        bool validate(MAPF_Instance* P, int num_threads = 0) const;
 };
 
 using Plans = std::vector<Plan>;
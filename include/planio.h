@@ -0,0 +1,96 @@
+#pragma once
+#include "logger.h"
+#include "plan.h"
+
+
+// binary plan format (version 1), little-endian
+//   header : magic "MAPFPLAN", version, agents, width, height, map hash, block size
+//   blocks : per block of timesteps, the state of every agent at the first
+//            timestep followed by varint tokens, either a zigzag code delta
+//            or a run of unchanged steps; per-agent offsets allow random access
+//   footer : block offsets, number of blocks, number of timesteps, "MAPFEND"
+constexpr char PLAN_MAGIC[8] = {'M', 'A', 'P', 'F', 'P', 'L', 'A', 'N'};
+constexpr char PLAN_MAGIC_END[8] = {'M', 'A', 'P', 'F', 'E', 'N', 'D', '\0'};
+constexpr uint32_t PLAN_VERSION = 1;
+constexpr size_t PLAN_HEADER_SIZE = 40;
+constexpr size_t PLAN_FOOTER_SIZE = 24;
+
+// writes a plan incrementally, one configuration at a time
+class PlanWriter {
+    private:
+        std::ofstream file;
+        const std::string filename;
+        const int num_agents;
+        const int block_size;
+        int length;             // number of timesteps written
+        int steps;              // number of timesteps in current block
+        std::vector<uint32_t> prev;                 // most recent state code of each agent
+        std::vector<uint64_t> run;                  // pending unchanged steps of each agent
+        std::vector<std::vector<uint8_t>> buf;      // encoded current block of each agent
+        std::vector<uint64_t> blocks;               // file offsets of blocks
+        bool closed;
+
+        void flush();
+        void check();           // raises if a write failed, e.g. on a full disk
+
+    protected:
+        LOGGER(PlanWriter);
+
+    public:
+        PlanWriter(const std::string& filename, const Grid* G, int num_agents, int block_size = 256);
+        ~PlanWriter();
+        PlanWriter(const PlanWriter&) = delete;
+        PlanWriter& operator=(const PlanWriter&) = delete;
+
+        int getLength() const {return length;}
+        void push(const Config& c);
+        void close();           // raises if the file is incomplete
+};
+
+// memory-mapped random access to a binary plan
+class PlanReader {
+    private:
+        struct Cursor {
+            const uint8_t* p;
+            const uint8_t* end;     // of the stream of the agent in the block
+            uint32_t code;
+            uint64_t run;
+            bool next();            // false if the stream is truncated
+        };
+
+        int fd;
+        const uint8_t* data;
+        size_t bytes;
+        int num_agents;
+        int width;
+        int height;
+        int block_size;
+        int length;
+        uint64_t map_hash;
+        std::vector<uint64_t> blocks;
+
+        void load(const std::string& filename);     // validates the layout against the file size
+        void release();
+        Cursor cursor(int b, int i) const;
+        void advance(Cursor& c) const;
+
+    protected:
+        LOGGER(PlanReader);
+
+    public:
+        PlanReader(const std::string& filename);
+        ~PlanReader();
+        PlanReader(const PlanReader&) = delete;
+        PlanReader& operator=(const PlanReader&) = delete;
+
+        int size() const {return num_agents;}
+        int getWidth() const {return width;}
+        int getHeight() const {return height;}
+        int getMakespan() const {return std::max(0, length - 1);}
+        uint64_t getMapHash() const {return map_hash;}
+        void checkMap(const Grid* G) const;     // raises unless the plan was made for G
+
+        PackedState get(const int t, const int i) const;
+        Path getPath(const int i) const;
+        Plan toPlan(const Grid* G) const;
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include "logger.h"
+#include "solver.h"
+
+
+// runs several solvers concurrently on one instance, sharing the distance table
+class Portfolio : public MAPF_Solver {
+    public:
+        enum class Mode {FIRST, BEST_SOC, BEST_MAKESPAN};
+
+    private:
+        std::vector<std::unique_ptr<MAPF_Solver>> members;
+        Mode mode;
+        int winner;         // member providing the solution, -1 if none
+
+        void run();
+
+    protected:
+        LOGGER(Portfolio);
+
+    public:
+        Portfolio(MAPF_Instance* P, std::vector<std::unique_ptr<MAPF_Solver>> members, Mode mode = Mode::FIRST);
+        ~Portfolio() {}
+
+        static Mode parseMode(const std::string& name);
+        Mode getMode() const {return mode;}
+        int size() const {return (int)members.size();}
+        int getWinner() const {return winner;}
+        const MAPF_Solver* getMember(const int k) const {return members.at(k).get();}
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "logger.h"
+#include "reservation.h"
+#include "solver.h"
+
+
+// prioritized planning: agents take shortest space-time paths one by one,
+// avoiding the paths of agents planned before them; on failure the search
+// restarts with the failed agent first
+template <typename Motion>
+class PrioritizedPlanning : public MAPF_Solver {
+    private:
+        ReservationTable table;
+        std::vector<Path> paths;
+        DistanceTable steps;            // fewest steps to goal, admissible heuristic of the search
+        std::vector<int> order;         // planning order of the last attempt
+        int hold_window;                // timesteps the starts of agents not planned yet are held
+        int max_restarts;
+        int num_restarts;               // restarts of the last search
+        int num_expanded;               // space-time states expanded over all attempts
+
+        bool plan(int& failed);
+        void run();
+
+    protected:
+        LOGGER(PrioritizedPlanning);
+
+    public:
+        PrioritizedPlanning(MAPF_Instance* P) :
+            MAPF_Solver(P),
+            table(G),
+            hold_window(10),
+            max_restarts(10),
+            num_restarts(0),
+            num_expanded(0) {
+                solver_name = "PP";
+            }
+        ~PrioritizedPlanning() {}
+
+        int getHoldWindow() const {return hold_window;}
+        void setHoldWindow(const int t) {hold_window = t;}
+        int getMaxRestarts() const {return max_restarts;}
+        void setMaxRestarts(const int n) {max_restarts = n;}
+        int getNumRestarts() const {return num_restarts;}
+        int getNumExpanded() const {return num_expanded;}
+        const std::vector<int>& getOrder() const {return order;}
+};
+
+extern template class PrioritizedPlanning<Omnidirectional>;
+extern template class PrioritizedPlanning<Oriented>;
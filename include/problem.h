@@ -1,9 +1,10 @@
 #pragma once
 #include "logger.h"
 #include "graph.h"
+#include "motion.h"
 
 
-using Config = std::vector<State>;
+using Config = std::vector<PackedState>;
 using Configs = std::vector<Config>;
 
 class Problem {
@@ -11,22 +12,23 @@ class Problem {
         LOGGER(Problem);
 
         Grid* G;
-        std::mt19937* MT;
+        uint64_t seed;
         int max_timestep;       // maximum number of discrete steps
         int max_comp_time;      // maximum computation time limit (ms)
 
     public:
         Problem() {}
-        Problem(Grid* G, std::mt19937* MT, int max_timestep, int max_comp_time) :
-            G(G), MT(MT), max_timestep(max_timestep), max_comp_time(max_comp_time) {}
+        Problem(Grid* G, uint64_t seed, int max_timestep, int max_comp_time) :
+            G(G), seed(seed), max_timestep(max_timestep), max_comp_time(max_comp_time) {}
         virtual ~Problem() = default;
 
         Grid* getG() const {return G;}
-        std::mt19937* getMT() const {return MT;}
+        uint64_t getSeed() const {return seed;}
         int getMaxTimestep() const {return max_timestep;}
         int getMaxCompTime() const {return max_comp_time;}
         void setMaxTimestep(const int t) {max_timestep = t;}
         void setMaxCompTime(const int t) {max_comp_time = t;}
+        void setSeed(const uint64_t s) {seed = s;}
 };
 
 class MAPF_Instance : public Problem {
@@ -35,21 +37,31 @@ class MAPF_Instance : public Problem {
         Config config_s;        // start configuration
         Config config_g;        // goal configuration
         int num_agents;
+        uint64_t revision;      // bumped on every change of starts or goals
+        std::vector<uint64_t> start_revision;       // revision of last start change per agent
+        std::vector<uint64_t> goal_revision;        // revision of last goal change per agent
         
         void setRandomStartsGoals();
+        void resetRevisions();
 
     public:
-        MAPF_Instance(Grid* G, std::mt19937* MT, int max_timestep, int max_comp_time) :
-            Problem(G, MT, max_timestep, max_comp_time), instance_name("custom"), num_agents(0) {}
+        MAPF_Instance(Grid* G, uint64_t seed, int max_timestep, int max_comp_time) :
+            Problem(G, seed, max_timestep, max_comp_time), instance_name("custom"), num_agents(0), revision(0) {}
         ~MAPF_Instance() = default;
 
         std::string getInstanceFileName() const {return instance_name;}
         int getNum() const {return num_agents;}
-        Config getConfigStart() const {return config_s;}
-        Config getConfigGoal() const {return config_g;}
+        const Config& getConfigStart() const {return config_s;}
+        const Config& getConfigGoal() const {return config_g;}
         State getStart(int i) const;
         State getGoal(int i) const;
+        MotionModel getMotionModel() const;
+        uint64_t getRevision() const {return revision;}
+        uint64_t getStartRevision(int i) const {return start_revision[i];}
+        uint64_t getGoalRevision(int i) const {return goal_revision[i];}
 
         void make(int num_agents);      // make random instance
         void make(const Config& config_s, const Config& config_g, int num_agents);
+        void setStart(int i, const State& s);       // change a single agent, see PIBT::replan
+        void setGoal(int i, const State& g);
 };
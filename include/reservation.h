@@ -0,0 +1,64 @@
+#pragma once
+#include "logger.h"
+#include "motion.h"
+
+
+// nodes occupied by planned paths over time, hashed on (timestep, node)
+// so that lookups stay O(1) however many agents are reserved; agents not
+// planned yet may hold their nodes for the first timesteps
+class ReservationTable {
+    private:
+        const uint64_t num_nodes;
+        std::unordered_map<uint64_t, int> table;        // (timestep, node) to agent
+        int horizon;                // no reservation at or after this timestep
+        std::vector<int> held;      // agent holding each node, -1 if none
+        int hold_window;            // held nodes are occupied until this timestep, inclusive
+
+        uint64_t key(int t, int v) const {return (uint64_t)t * num_nodes + v;}
+
+    protected:
+        LOGGER(ReservationTable);
+
+    public:
+        ReservationTable(const Grid* G) : num_nodes(G->size()), horizon(0), held(G->size(), -1), hold_window(-1) {}
+        ~ReservationTable() {}
+
+        int occupant(int t, int v) const;       // agent at node v at timestep t, -1 if none
+        bool isFree(int t, Node* const v) const {return occupant(t, v->id) == -1;}
+        bool canMove(int t, Node* const u, Node* const v) const;       // from u at t to v at t + 1
+        void reserve(const int i, const Path& path);       // path starts at timestep 0, empty states are skipped
+        void release(const int i, const Path& path);
+        void hold(const int i, Node* const v) {held[v->id] = i;}
+        void unhold(Node* const v) {held[v->id] = -1;}
+        int holder(Node* const v) const {return held[v->id];}
+        void setHoldWindow(const int t) {hold_window = t;}
+        int getHoldWindow() const {return hold_window;}
+        void clear();       // reservations and held nodes
+        size_t size() const {return table.size();}
+        int getHorizon() const {return std::max(horizon, hold_window + 1);}      // nothing occupied from then on
+};
+
+// space-time A* over (node, heading, timestep) avoiding reservations;
+// the agent leaves on arrival, so nothing is reserved for it at its goal
+template <typename Motion>
+class SpaceTimeAStar {
+    private:
+        const Grid* const G;
+        const ReservationTable& table;
+        int expanded;       // number of expansions of the last search
+
+    protected:
+        LOGGER(SpaceTimeAStar);
+
+    public:
+        SpaceTimeAStar(const Grid* G, const ReservationTable& table) : G(G), table(table), expanded(0) {}
+        ~SpaceTimeAStar() {}
+
+        // h is an admissible number of steps to the goal, e.g. ignoring weights; interrupted is polled periodically
+        bool findPath(const PackedState& start, const PackedState& goal, const std::function<int(Node*)>& h,
+            int max_timestep, Path& path, const std::function<bool()>& interrupted = nullptr);
+        int getNumExpanded() const {return expanded;}
+};
+
+extern template class SpaceTimeAStar<Omnidirectional>;
+extern template class SpaceTimeAStar<Oriented>;
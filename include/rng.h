@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+
+// independent random streams, one per consumer
+enum class Stream : uint64_t {INSTANCE, PRIORITY, TIEBREAK, SEARCH};
+
+// counter-based generator; the n-th output of a stream is a pure function
+// of (seed, stream, n), so streams can be derived per agent and timestep
+// and consumed from any thread without shared state
+class RNG {
+    private:
+        uint64_t key;       // stream identifier
+        uint64_t counter;   // position within stream
+
+        static constexpr uint64_t GAMMA = 0x9e3779b97f4a7c15ULL;
+
+        static constexpr uint64_t mix(uint64_t z) {
+            // splitmix64 finalizer
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        RNG(uint64_t key, uint64_t counter, bool) : key(key), counter(counter) {}
+
+    public:
+        using result_type = uint64_t;
+
+        explicit RNG(uint64_t seed = 0, Stream stream = Stream::INSTANCE) :
+            key(mix(mix(seed) + ((uint64_t)stream + 1) * GAMMA)), counter(0) {}
+
+        static constexpr result_type min() {return 0;}
+        static constexpr result_type max() {return UINT64_MAX;}
+
+        result_type operator()() {return mix(key + (++counter) * GAMMA);}
+        void discard(uint64_t n) {counter += n;}
+
+        // sub-stream keyed by e.g. (agent, timestep)
+        RNG derive(uint64_t i, uint64_t j = 0) const {
+            uint64_t k = mix(key ^ mix(i + GAMMA));
+            return RNG(mix(k ^ mix(j + 2 * GAMMA)), 0, true);
+        }
+};
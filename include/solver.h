@@ -8,11 +8,12 @@ class MinimumSolver {
     private:
         int comp_time;
         Time::time_point t_start;
+        std::atomic<bool> stop_requested;
 
     protected:
         std::string solver_name;
         Grid* const G;
-        std::mt19937* const MT;
+        uint64_t seed;
         const int max_timestep;
         const int max_comp_time;
         Plan solution;
@@ -28,29 +29,47 @@ class MinimumSolver {
         int getSolverElapsedTime() const {
             return getElapsedTime(t_start);
         }
+        bool stopRequested() const {return stop_requested;}
 
     protected:
         void start() {t_start = Time::now();}
-        void end() {comp_time = getSolverElapsedTime();}
+        void end() {
+            comp_time = getSolverElapsedTime();
+            stop_requested = false;     // a stop request ends the current solve only
+            solution.closeStream();
+        }
         virtual void exec() = 0;
 
     public:
         MinimumSolver(Problem* P) :
             solver_name(""),
             G(P->getG()),
-            MT(P->getMT()),
+            seed(P->getSeed()),
             max_timestep(P->getMaxTimestep()),
             max_comp_time(P->getMaxCompTime()),
+            solution(P->getG()),
             solved(false),
-            comp_time(0) {}
+            comp_time(0),
+            stop_requested(false) {}
         virtual ~MinimumSolver() {}
         virtual void solve() {
+            // every solve starts from an empty plan, e.g. a portfolio member solving again
+            solution.clear();
+            solved = false;
             start(); exec(); end();
         }
 
-        Plan getSolution() const {return solution;}
+        const Plan& getSolution() const {return solution;}
+        // write configs to a binary plan file while solving
+        void streamSolution(const std::string& filename, int block_size = 256) {
+            solution.stream(filename, block_size);
+        }
         bool succeed() const {return solved;}
         std::string getSolverName() const {return solver_name;}
+        uint64_t getSeed() const {return seed;}
+        void setSeed(const uint64_t s) {seed = s;}
+        void requestStop() {stop_requested = true;}     // safe to call from another thread
+        void clearStop() {stop_requested = false;}      // drop a request that arrived after the solve ended
         int getMaxTimestep() const {return max_timestep;}
         int getCompTime() const {return comp_time;}
 };
@@ -60,17 +79,32 @@ class MAPF_Solver : public MinimumSolver {
         int LB_soc;     // number of steps
         int LB_makespan;
 
+    public:
+        using DistanceTable = std::vector<std::vector<int>>;
+
     protected:
         MAPF_Instance* const P;
         int precomp_time;
-        using DistanceTable = std::vector<std::vector<int>>;
-        DistanceTable distance_table;       // number of steps to target
+        std::shared_ptr<DistanceTable> distance_table;      // number of steps to target, may be shared; empty until created
+        bool distance_shared;
+        // rows of recently used goals, keyed by node id, with their place in the eviction order
+        std::unordered_map<int, std::pair<std::vector<int>, std::list<int>::iterator>> distance_cache;
+        std::list<int> cache_order;         // least recently used first
+        size_t cache_capacity;              // number of rows
+        static constexpr size_t CACHE_BYTES = 64 << 20;     // default budget, a row is one int per node
     
     private:
         void computeLowerBounds();
         void exec();
+        void trimDistanceCache(const size_t n);     // evicts the least recently used rows down to n
+
+    protected:
+        void computeDistance(std::vector<int>& row, Node* const g) const;
+        void computeSteps(std::vector<int>& row, Node* const g) const;     // fewest steps, whatever the weights
+        void addPaths(const std::vector<Path>& paths);      // append configs of paths starting at timestep 0
 
     protected:
+        LOGGER(MAPF_Solver);
         virtual void run() {}
 
     public:
@@ -80,17 +114,30 @@ class MAPF_Solver : public MinimumSolver {
             LB_soc(0),
             LB_makespan(0),
             precomp_time(0),
-            distance_table(P->getNum(), std::vector<int>(G->size(), max_timestep)) {}
+            distance_table(std::make_shared<DistanceTable>()),
+            distance_shared(false),
+            cache_capacity(std::min<size_t>(256, CACHE_BYTES / (G->size() * sizeof(int)))) {}
         virtual ~MAPF_Solver() {}
 
-        MAPF_Instance* getP() {return P;}
+        MAPF_Instance* getP() const {return P;}
         int getLowerBoundSOC();
         int getLowerBoundMakespan();
-        int getPreCompTime() {return precomp_time;}
-        DistanceTable getDistanceTable() {return distance_table;}
+        int getPreCompTime() const {return precomp_time;}
+        const DistanceTable& getDistanceTable() const {return *distance_table;}
+        std::shared_ptr<DistanceTable> getSharedDistanceTable() const {return distance_table;}
+        void shareDistanceTable(std::shared_ptr<DistanceTable> table);     // use a table computed for the same instance
 
         int pathDist(Node* const u, Node* const v) const;       // number of steps from node u to node v
         int pathDist(const int i, Node* const u) const;         // number of steps for agent i from node u
         int pathDist(const int i) const;                        // number of steps for agent i
         void createDistanceTable();
+        void updateDistance(const int i, Node* const g);        // row of agent i towards node g, cached
+        size_t getDistanceCacheSize() const {return distance_cache.size();}
+        size_t getDistanceCacheCapacity() const {return cache_capacity;}
+        bool isDistanceCached(Node* const g) const {return distance_cache.count(g->id) > 0;}
+        void clearDistanceCache() {
+            distance_cache.clear();
+            cache_order.clear();
+        }
+        void setDistanceCacheCapacity(const size_t n);     // evicts the oldest rows beyond the capacity
 };
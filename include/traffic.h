@@ -0,0 +1,81 @@
+#pragma once
+#include "logger.h"
+#include "motion.h"
+#include "plan.h"
+
+
+// traffic of executed plans per directed edge and per cell; channels follow
+// the weight layer of the graph, 0 : +y, 1 : -x, 2 : -y, 3 : +x
+class TrafficStats {
+    private:
+        const Grid* G;
+        std::vector<int> flows;         // moves along each (node, channel)
+        std::vector<int> visits;        // timesteps agents spent in each node
+        std::vector<int> waits;         // timesteps agents stayed in each node, turns included
+        int64_t steps;                  // recorded agent steps
+        int num_plans;
+
+    protected:
+        LOGGER(TrafficStats);
+
+    public:
+        TrafficStats(const Grid* G);
+        ~TrafficStats() {}
+
+        void record(const Plan& plan);
+        void clear();
+
+        int getFlow(Node* const u, const int ch) const {return flows[u->id * 4 + ch];}
+        int getContraFlow(Node* const u, const int ch) const;      // moves over the same edge the other way
+        int getVisits(Node* const v) const {return visits[v->id];}
+        int getWaits(Node* const v) const {return waits[v->id];}
+        int64_t getNumSteps() const {return steps;}
+        int getNumPlans() const {return num_plans;}
+        float getWaitRatio() const;         // waits per recorded step
+};
+
+// learns the weight layer of a graph from the traffic of lifelong PIBT on a
+// task distribution: contra-flow and waits raise the cost of edges, and an
+// update is kept only if it increases the throughput, otherwise the step shrinks
+template <typename Motion>
+class GuidanceOptimizer {
+    private:
+        Grid* const G;
+        const int num_agents;
+        const std::vector<State> tasks;     // goals issued in order to agents finishing their task
+        const int horizon;                  // timesteps of each evaluation
+        const uint64_t seed;                // of the start configuration
+        const std::vector<float> initial;   // weights the penalties scale
+        float contra_flow_penalty;          // cost added against the dominant direction of an edge
+        float congestion_penalty;           // cost added for entering the cells with the most waits
+        float max_weight;
+        TrafficStats stats;                 // of the last evaluation
+        std::vector<float> best;
+        float best_throughput;
+        std::vector<float> history;         // throughput of every evaluation
+
+        std::vector<float> propose(const std::vector<float>& base, const float step) const;
+
+    protected:
+        LOGGER(GuidanceOptimizer);
+
+    public:
+        GuidanceOptimizer(Grid* G, int num_agents, const std::vector<State>& tasks, int horizon, uint64_t seed = 0);
+        ~GuidanceOptimizer() {}
+
+        float getContraFlowPenalty() const {return contra_flow_penalty;}
+        void setContraFlowPenalty(const float p) {contra_flow_penalty = p;}
+        float getCongestionPenalty() const {return congestion_penalty;}
+        void setCongestionPenalty(const float p) {congestion_penalty = p;}
+        float getMaxWeight() const {return max_weight;}
+        void setMaxWeight(const float w) {max_weight = w;}
+
+        float evaluate();                   // throughput under the current weights, traffic recorded
+        float optimize(const int iterations);       // leaves the best weights on the graph
+        const TrafficStats& getStats() const {return stats;}
+        float getBestThroughput() const {return best_throughput;}
+        const std::vector<float>& getHistory() const {return history;}
+};
+
+extern template class GuidanceOptimizer<Omnidirectional>;
+extern template class GuidanceOptimizer<Oriented>;
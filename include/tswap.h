@@ -0,0 +1,44 @@
+#pragma once
+#include "logger.h"
+#include "solver.h"
+
+
+// unlabeled MAPF: any agent may serve any goal (TSWAP); goals are assigned
+// greedily on the distance fields and swapped between agents while moving
+// whenever that breaks a deadlock or reduces the remaining distance
+template <typename Motion>
+class TSWAP : public MAPF_Solver {
+    private:
+        std::vector<int> assignment;        // goal index of each agent
+        std::vector<int> occupied;          // agent per node, -1 if empty
+        int num_swaps;                      // goal exchanges while moving
+        int timestep;                       // keys the random streams
+
+        int dist(const int i, Node* const v) const {return pathDist(assignment[i], v);}
+        bool atGoal(const Config& C, const int i) const {return C[i] == P->getConfigGoal()[assignment[i]];}
+        void assignGoals();
+        Node* getNextNode(const Config& C, const int i) const;
+        void resolve(const Config& C, const int i);
+        void step(const Config& C, Config& Q);
+        void run();
+
+    protected:
+        LOGGER(TSWAP);
+
+    public:
+        TSWAP(MAPF_Instance* P) :
+            MAPF_Solver(P),
+            occupied(G->size(), -1),
+            num_swaps(0),
+            timestep(0) {
+                solver_name = "TSWAP";
+            }
+        ~TSWAP() {}
+
+        const std::vector<int>& getAssignment() const {return assignment;}
+        Config getAssignedGoals() const;        // goal state of each agent, for validation
+        int getNumSwaps() const {return num_swaps;}
+};
+
+extern template class TSWAP<Omnidirectional>;
+extern template class TSWAP<Oriented>;
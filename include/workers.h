@@ -0,0 +1,32 @@
+#pragma once
+#include "logger.h"
+
+
+// threads kept alive across rounds of work, e.g. the steps of a solver; the
+// caller takes part in every round, so a pool of n threads starts n - 1 workers
+class WorkerPool {
+    private:
+        std::vector<std::thread> threads;
+        std::mutex mtx;
+        std::condition_variable wake;       // a round starts or the pool stops
+        std::condition_variable idle;       // the last worker finished its round
+        std::function<void()> job;
+        uint64_t round;
+        int pending;                        // workers still busy with the current round
+        bool stopping;
+        std::exception_ptr failure;         // first exception thrown by a worker
+
+        void loop();
+
+    protected:
+        LOGGER(WorkerPool);
+
+    public:
+        WorkerPool(int num_threads);
+        ~WorkerPool();
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        int size() const {return (int)threads.size() + 1;}
+        void run(const std::function<void()>& fn);      // fn on every thread, returns once all are done
+};
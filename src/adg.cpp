@@ -0,0 +1,336 @@
+#include "adg.h"
+#include "reservation.h"
+
+
+ActionDependencyGraph::ActionDependencyGraph(const Plan& plan) :
+    G(plan.getG()),
+    delay_tolerance(3),
+    num_edges(0),
+    num_replans(0) {
+        if (G == nullptr) error("Plan without graph");
+        std::vector<Path> paths(plan.size());
+        for (int i = 0; i < plan.size(); ++i) paths[i] = plan.getPath(i);
+        build(paths);
+    }
+
+void ActionDependencyGraph::build(const std::vector<Path>& paths) {
+    const int N = (int)paths.size();
+    actions.assign(N, std::vector<Vertex>());
+    starts.assign(N, PackedState());
+    completed.assign(N, 0);
+    released.assign(N, false);
+    delays.assign(N, 0);
+    rotations.clear();
+    num_edges = 0;
+
+    // stays of agents in cells, entered and left by actions (-1 for none)
+    struct Visit {
+        int agent;
+        int enter;
+        int leave;
+        int t;          // timestep of arrival
+    };
+    std::unordered_map<int, std::vector<Visit>> visits;
+    for (int i = 0; i < N; ++i) {
+        const Path& path = paths[i];
+        if (path.empty() || path[0].empty()) {
+            for (auto& s : path) {
+                if (!s.empty()) error("Execution of agents entering after the start is not supported");
+            }
+            continue;
+        }
+        starts[i] = path[0];
+        int cell = path[0].id();
+        Visit visit = {i, -1, -1, 0};
+        for (int t = 0; t + 1 < (int)path.size(); ++t) {
+            const PackedState s = path[t], q = path[t + 1];
+            if (q.empty()) {
+                for (int u = t + 1; u < (int)path.size(); ++u) {
+                    if (!path[u].empty()) error("Execution of agents reappearing after leaving is not supported");
+                }
+                break;
+            }
+            if (s == q) continue;       // waits are left to the dependencies
+            Action action = Action::MOVE;
+            if (s.id() == q.id()) {
+                action = (q.orientation() == Heading::LEFT[s.orientation()]) ? Action::TURN_LEFT : Action::TURN_RIGHT;
+            }
+            const int k = (int)actions[i].size();
+            actions[i].push_back({{i, k, action, s, q, t, -1}, {}, {}, 0});
+            if (action == Action::MOVE) {
+                visit.leave = k;
+                visits[cell].push_back(visit);
+                cell = q.id();
+                visit = {i, k, -1, t + 1};
+            }
+        }
+        // others enter the goal once the agent arrived and left
+        visit.leave = (int)actions[i].size() - 1;
+        visits[cell].push_back(visit);
+    }
+
+    // agents following each other in one timestep close rotations; such
+    // cycles cannot wait on each other and are released together
+    auto key = [&](int i, int k) {return ((uint64_t)i << 32) | (uint32_t)k;};
+    std::unordered_map<uint64_t, uint64_t> follows;
+    for (auto& [v, list] : visits) {
+        std::sort(list.begin(), list.end(), [](const Visit& a, const Visit& b) {return a.t < b.t;});
+        for (size_t n = 1; n < list.size(); ++n) {
+            const Visit& prev = list[n - 1];
+            const Visit& curr = list[n];
+            if (prev.leave == -1 || curr.enter == -1) continue;
+            if (actions[prev.agent][prev.leave].command.t == actions[curr.agent][curr.enter].command.t) {
+                follows[key(curr.agent, curr.enter)] = key(prev.agent, prev.leave);
+            }
+        }
+    }
+    std::unordered_set<uint64_t> seen;
+    for (auto& [x, y] : follows) {
+        if (seen.count(x)) continue;
+        std::vector<uint64_t> chain = {x};
+        seen.insert(x);
+        for (auto itr = follows.find(x); itr != follows.end(); itr = follows.find(itr->second)) {
+            if (itr->second == x) {
+                rotations.emplace_back();
+                for (auto z : chain) {
+                    const int i = (int)(z >> 32), k = (int)(uint32_t)z;
+                    actions[i][k].command.rotation = (int)rotations.size() - 1;
+                    rotations.back().emplace_back(i, k);
+                }
+                break;
+            }
+            if (!seen.insert(itr->second).second) break;
+            chain.push_back(itr->second);
+        }
+    }
+
+    for (auto& [v, list] : visits) {
+        for (size_t n = 1; n < list.size(); ++n) {
+            const Visit& prev = list[n - 1];
+            const Visit& curr = list[n];
+            if (prev.leave == -1) continue;
+            if (curr.enter == -1) error("Agents share a start node");
+            Vertex& b = actions[curr.agent][curr.enter];
+            if (b.command.rotation != -1 && actions[prev.agent][prev.leave].command.rotation == b.command.rotation) continue;
+            Vertex& a = actions[prev.agent][prev.leave];
+            a.dependents.emplace_back(curr.agent, curr.enter);
+            b.dependencies.emplace_back(prev.agent, prev.leave);
+            ++b.unmet;
+            ++num_edges;
+        }
+    }
+}
+
+int ActionDependencyGraph::getNumActions() const {
+    int cnt = 0;
+    for (auto& list : actions) cnt += (int)list.size();
+    return cnt;
+}
+
+bool ActionDependencyGraph::finished() const {
+    for (int i = 0; i < size(); ++i) {
+        if (!finished(i)) return false;
+    }
+    return true;
+}
+
+PackedState ActionDependencyGraph::getState(const int i) const {
+    if (finished(i)) return PackedState();
+    if (completed[i] == 0) return starts[i];
+    return actions[i][completed[i] - 1].command.to;
+}
+
+MotionModel ActionDependencyGraph::getMotionModel() const {
+    // agents without heading move omnidirectionally
+    int omni = 0, total = 0;
+    auto count = [&](const PackedState& s) {
+        if (s.empty()) return;
+        omni += (s.orientation() == -1);
+        ++total;
+    };
+    for (int i = 0; i < size(); ++i) {
+        count(starts[i]);
+        for (auto& v : actions[i]) count(v.command.to);
+    }
+    if (omni == 0) return MotionModel::ORIENTED;
+    if (omni == total) return MotionModel::OMNIDIRECTIONAL;
+    return MotionModel::MIXED;
+}
+
+std::vector<ActionDependencyGraph::Command> ActionDependencyGraph::release() {
+    auto ready = [&](int i, int k) {
+        return !released[i] && completed[i] == k && actions[i][k].unmet == 0;
+    };
+    std::vector<Command> commands;
+    for (int i = 0; i < size(); ++i) {
+        if (finished(i) || !ready(i, completed[i])) continue;
+        const Command& command = actions[i][completed[i]].command;
+        if (command.rotation == -1) {
+            released[i] = true;
+            commands.push_back(command);
+            continue;
+        }
+        auto& members = rotations[command.rotation];
+        if (!std::all_of(members.begin(), members.end(), [&](auto m) {return ready(m.first, m.second);})) continue;
+        for (auto [j, l] : members) {
+            released[j] = true;
+            commands.push_back(actions[j][l].command);
+        }
+    }
+    return commands;
+}
+
+void ActionDependencyGraph::reportCompletion(const int i) {
+    if (!released[i]) error("Agent " + std::to_string(i) + " has no released action");
+    for (auto [j, l] : actions[i][completed[i]].dependents) --actions[j][l].unmet;
+    ++completed[i];
+    released[i] = false;
+    delays[i] = 0;
+}
+
+void ActionDependencyGraph::reportDelay(const int i, const int steps) {
+    if (finished(i)) error("Agent " + std::to_string(i) + " has no action left");
+    delays[i] += steps;
+}
+
+bool ActionDependencyGraph::blocked(const int i, std::vector<int>& memo) const {
+    // 0 : unknown, 1 : visiting, 2 : blocked, 3 : free
+    if (memo[i] != 0) return memo[i] == 2;
+    memo[i] = 1;
+    bool result = false;
+    if (!released[i] && !finished(i)) {
+        const Vertex& a = actions[i][completed[i]];
+        std::vector<int> owners;        // of unmet dependencies, and the rest of a rotation
+        for (auto [j, l] : a.dependencies) {
+            if (l >= completed[j]) owners.push_back(j);
+        }
+        if (a.command.rotation != -1) {
+            for (auto [j, l] : rotations[a.command.rotation]) {
+                if (j != i && l > completed[j]) owners.push_back(j);
+            }
+        }
+        for (auto j : owners) {
+            if (delays[j] > delay_tolerance || blocked(j, memo)) {
+                result = true;
+                break;
+            }
+        }
+    }
+    memo[i] = result ? 2 : 3;
+    return result;
+}
+
+std::vector<int> ActionDependencyGraph::getBlockedAgents() const {
+    std::vector<int> memo(size(), 0);
+    std::vector<int> agents;
+    for (int i = 0; i < size(); ++i) {
+        if (blocked(i, memo)) agents.push_back(i);
+    }
+    return agents;
+}
+
+std::vector<Path> ActionDependencyGraph::schedule() const {
+    // longest paths over the remaining graph, one step per action plus the delays
+    const int N = size();
+    std::vector<std::vector<int>> ready(N), indegree(N);
+    std::queue<std::pair<int, int>> OPEN;
+    for (int i = 0; i < N; ++i) {
+        ready[i].assign(actions[i].size(), 0);
+        indegree[i].assign(actions[i].size(), 0);
+        for (int k = completed[i]; k < (int)actions[i].size(); ++k) {
+            indegree[i][k] = actions[i][k].unmet + (k > completed[i] ? 1 : 0);
+            if (indegree[i][k] == 0) OPEN.push({i, k});
+        }
+    }
+    std::vector<Path> paths(N);
+    for (int i = 0; i < N; ++i) {
+        if (!finished(i)) paths[i].push_back(getState(i));
+    }
+    auto relax = [&](int j, int l, int t) {
+        ready[j][l] = std::max(ready[j][l], t);
+        if (--indegree[j][l] == 0) OPEN.push({j, l});
+    };
+    auto settle = [&](int i, int k, int start) {
+        const int finish = start + 1 + (k == completed[i] ? delays[i] : 0);
+        paths[i].resize(finish, paths[i].back());
+        paths[i].push_back(actions[i][k].command.to);
+        if (k + 1 < (int)actions[i].size()) relax(i, k + 1, finish);
+        for (auto [j, l] : actions[i][k].dependents) relax(j, l, finish);
+    };
+    std::vector<int> arrived(rotations.size(), 0);      // members of each rotation ready
+    while (!OPEN.empty()) {
+        auto [i, k] = OPEN.front(); OPEN.pop();
+        const int r = actions[i][k].command.rotation;
+        if (r == -1) {
+            settle(i, k, ready[i][k]);
+            continue;
+        }
+        if (++arrived[r] < (int)rotations[r].size()) continue;
+        int start = 0;
+        for (auto [j, l] : rotations[r]) start = std::max(start, ready[j][l]);
+        for (auto [j, l] : rotations[r]) settle(j, l, start);
+    }
+    return paths;
+}
+
+template <typename Motion>
+bool ActionDependencyGraph::replan(const int max_timestep) {
+    const MotionModel model = std::is_same_v<Motion, Oriented> ? MotionModel::ORIENTED : MotionModel::OMNIDIRECTIONAL;
+    if (getMotionModel() != model) error(std::string("Plan does not match the ") + Motion::name + " motion model");
+    const std::vector<int> agents = getBlockedAgents();
+    if (agents.empty()) return true;
+    info("Replanning " + std::to_string(agents.size()) + " blocked agents");
+
+    std::vector<Path> paths = schedule();
+    std::vector<bool> replanned(size(), false);
+    for (auto j : agents) replanned[j] = true;
+    ReservationTable table(G);
+    for (int i = 0; i < size(); ++i) {
+        if (replanned[i]) continue;
+        table.reserve(i, paths[i]);
+        if (released[i]) {
+            // a robot in motion occupies the cell ahead until it arrives
+            int t = 1;
+            while (paths[i][t] == paths[i][0]) ++t;
+            table.reserve(i, Path(t, paths[i][t]));
+        }
+    }
+
+    SpaceTimeAStar<Motion> search(G, table);
+    std::vector<int> dist(G->size());
+    for (auto j : agents) {
+        // distance-to-goal ignoring headings, admissible for both motions
+        const PackedState goal = actions[j].back().command.to;
+        std::fill(dist.begin(), dist.end(), max_timestep);
+        std::queue<Node*> OPEN;
+        OPEN.push(G->getNode(goal.id()));
+        dist[goal.id()] = 0;
+        for (; !OPEN.empty(); OPEN.pop()) {
+            for (auto v : OPEN.front()->neighbor) {
+                if (dist[v->id] != max_timestep) continue;
+                dist[v->id] = dist[OPEN.front()->id] + 1;
+                OPEN.push(v);
+            }
+        }
+        Path path;
+        if (!search.findPath(getState(j), goal, [&](Node* v) {return dist[v->id];}, max_timestep, path)) {
+            warn("No path of blocked agent " + std::to_string(j) + " around the others");
+            return false;
+        }
+        table.reserve(j, path);
+        paths[j] = path;
+    }
+
+    // commands in progress stay released, their delays are part of the new timing
+    const std::vector<bool> in_progress = released;
+    build(paths);
+    released = in_progress;
+    for (int i = 0; i < size(); ++i) {
+        if (released[i] && actions[i][0].unmet > 0) error("Replanning delayed a command in progress");
+    }
+    ++num_replans;
+    return true;
+}
+
+template bool ActionDependencyGraph::replan<Omnidirectional>(const int max_timestep);
+template bool ActionDependencyGraph::replan<Oriented>(const int max_timestep);
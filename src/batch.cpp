@@ -0,0 +1,60 @@
+#include "batch.h"
+
+
+BatchSolver::BatchSolver(Grid* G, const Parameters& params, int num_threads) :
+    G(G),
+    params(params),
+    num_threads(num_threads) {
+        if (this->num_threads <= 0) this->num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+void BatchSolver::solveOne(const InstanceSpec& spec, BatchResult& result, std::unique_ptr<Plan>& plan) const {
+    MAPF_Instance P(G, spec.seed, params.max_timestep, params.max_comp_time);
+    if (spec.starts.empty() && spec.goals.empty()) {
+        P.make(spec.num_agents);
+    } else {
+        P.make(spec.starts, spec.goals, (int)spec.starts.size());
+    }
+    std::unique_ptr<MAPF_Solver> solver(make_solver(&P, params));
+    solver->solve();
+
+    const Plan& solution = solver->getSolution();
+    result.solved = solver->succeed();
+    result.makespan = solution.getMakespan();
+    result.soc = solution.getSOC();
+    result.lb_makespan = solver->getLowerBoundMakespan();
+    result.lb_soc = solver->getLowerBoundSOC();
+    result.comp_time = solver->getCompTime();
+    result.precomp_time = solver->getPreCompTime();
+    if (spec.keep_plan) plan = std::make_unique<Plan>(solution);
+}
+
+void BatchSolver::solve(const InstanceSpecs& specs) {
+    auto t_start = Time::now();
+    results.assign(specs.size(), BatchResult());
+    plans.clear();
+    plans.resize(specs.size());
+
+    // workers pull the next instance, so long and short runs balance out
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t k = next++; k < specs.size(); k = next++) {
+            try {
+                solveOne(specs[k], results[k], plans[k]);
+            } catch (const std::exception& e) {
+                results[k] = BatchResult();
+                results[k].error = e.what();
+            }
+        }
+    };
+    int n = std::min<int>(num_threads, (int)specs.size());
+    std::vector<std::thread> threads;
+    for (int w = 1; w < n; ++w) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+
+    int failed = 0;
+    for (auto& result : results) failed += !result.error.empty();
+    if (failed > 0) warn(std::to_string(failed) + " of " + std::to_string(specs.size()) + " instances failed");
+    info("Solve " + std::to_string(specs.size()) + " instances on " + std::to_string(std::max(n, 1)) + " threads", t_start);
+}
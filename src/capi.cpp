@@ -0,0 +1,147 @@
+#include "mapf_c.h"
+#include "mapf.h"
+
+
+struct mapf_graph {
+    Grid G;
+    mapf_graph(const std::string& map, bool with_weights) : G(map, with_weights) {}
+};
+
+struct mapf_instance {
+    MAPF_Instance P;
+    mapf_instance(Grid* G, uint64_t seed, int max_timestep, int max_comp_time) :
+        P(G, seed, max_timestep, max_comp_time) {}
+};
+
+struct mapf_solver {
+    std::unique_ptr<MAPF_Solver> solver;
+};
+
+namespace {
+    thread_local std::string last_error;
+
+    // run body, converting exceptions to a status code
+    template <typename F>
+    int guard(F&& body) {
+        try {
+            body();
+            return MAPF_OK;
+        } catch (const std::exception& e) {
+            last_error = e.what();
+        } catch (...) {
+            last_error = "Unknown error";
+        }
+        return MAPF_ERROR;
+    }
+
+    Config toConfig(const Grid& G, const int32_t* states, int num_agents) {
+        Config config;
+        config.reserve(num_agents);
+        for (int i = 0; i < num_agents; ++i, states += 3) {
+            if (!G.existNode(states[0], states[1])) throw MAPFError("State outside of free cells");
+            if (!(-1 <= states[2] && states[2] < 4)) throw MAPFError("Invalid orientation");
+            config.emplace_back(G.getNode(states[0], states[1]), states[2]);
+        }
+        return config;
+    }
+}
+
+int mapf_api_version(void) {
+    return MAPF_C_API_VERSION;
+}
+
+const char* mapf_last_error(void) {
+    return last_error.c_str();
+}
+
+void mapf_set_verbose(int enabled) {
+    Logger::get().setVerbose(enabled != 0);
+}
+
+mapf_graph* mapf_graph_create(const char* map, int with_weights) {
+    mapf_graph* graph = nullptr;
+    guard([&] {graph = new mapf_graph(map, with_weights != 0);});
+    return graph;
+}
+
+void mapf_graph_destroy(mapf_graph* graph) {
+    delete graph;
+}
+
+int mapf_graph_width(const mapf_graph* graph) {
+    return graph->G.getWidth();
+}
+
+int mapf_graph_height(const mapf_graph* graph) {
+    return graph->G.getHeight();
+}
+
+mapf_instance* mapf_instance_create(mapf_graph* graph, uint64_t seed, int max_timestep, int max_comp_time) {
+    mapf_instance* instance = nullptr;
+    guard([&] {instance = new mapf_instance(&graph->G, seed, max_timestep, max_comp_time);});
+    return instance;
+}
+
+void mapf_instance_destroy(mapf_instance* instance) {
+    delete instance;
+}
+
+int mapf_instance_make_random(mapf_instance* instance, int num_agents) {
+    return guard([&] {instance->P.make(num_agents);});
+}
+
+int mapf_instance_make(mapf_instance* instance, const int32_t* starts, const int32_t* goals, int num_agents) {
+    return guard([&] {
+        const Grid& G = *instance->P.getG();
+        instance->P.make(toConfig(G, starts, num_agents), toConfig(G, goals, num_agents), num_agents);
+    });
+}
+
+int mapf_instance_num_agents(const mapf_instance* instance) {
+    return instance->P.getNum();
+}
+
+mapf_solver* mapf_solver_create(mapf_instance* instance, const char* name) {
+    mapf_solver* solver = nullptr;
+    guard([&] {
+        Parameters params;
+        params.solver = name;
+        solver = new mapf_solver{std::unique_ptr<MAPF_Solver>(make_solver(&instance->P, params))};
+    });
+    return solver;
+}
+
+void mapf_solver_destroy(mapf_solver* solver) {
+    delete solver;
+}
+
+int mapf_solver_solve(mapf_solver* solver) {
+    return guard([&] {solver->solver->solve();});
+}
+
+int mapf_solver_succeeded(const mapf_solver* solver) {
+    return solver->solver->succeed() ? 1 : 0;
+}
+
+int mapf_solver_comp_time(const mapf_solver* solver) {
+    return solver->solver->getCompTime();
+}
+
+int mapf_plan_makespan(const mapf_solver* solver) {
+    return solver->solver->getSolution().getMakespan();
+}
+
+int mapf_plan_path_length(const mapf_solver* solver, int agent) {
+    int length = MAPF_ERROR;
+    guard([&] {length = solver->solver->getSolution().getPathLength(agent);});
+    return length;
+}
+
+int mapf_plan_states(const mapf_solver* solver, int32_t* out, size_t capacity) {
+    return guard([&] {
+        const Plan& plan = solver->solver->getSolution();
+        size_t T = plan.empty() ? 0 : plan.getMakespan() + 1;
+        if (capacity < T * plan.size() * 3) throw MAPFError("Output buffer too small for plan");
+        plan.exportStates(out);
+    });
+}
@@ -1,4 +1,5 @@
 #include "graph.h"
+#include "motion.h"
 
 
 int Pos::manhattan(const Pos& pos) const {
@@ -54,6 +55,12 @@ std::ostream& operator<<(std::ostream& os, const State& state) {
     return os;
 }
 
+std::ostream& operator<<(std::ostream& os, const PackedState& state) {
+    os << "(" << std::right << std::setw(6) << state.id() << ","
+        << std::right << std::setw(3) << state.orientation() << ")";
+    return os;
+}
+
 Grid::Grid(const std::string& map_file, bool load_weights) : map_file(map_file) {
     // load graph using map file
     auto t_start = Time::now();
@@ -136,23 +143,7 @@ Grid::Grid(const std::string& map_file, bool load_weights) : map_file(map_file)
                 }
             }
             // write weights file
-            std::ofstream myfile(map_file + ".weights");
-            myfile << "height " << height << std::endl;
-            myfile << "width " << width << std::endl;
-            myfile << "channels " << channels << std::endl;
-            for (int y = 0; y < height; ++y) {
-                for (int x = 0; x < width; ++x) {
-                    if (!existNode(x, y)) continue;
-                    myfile << x << " " << y;
-                    for (int ch = 0; ch < channels; ++ch) {
-                        float w = getWeight(x, y, ch);
-                        if (w >= MAX_WEIGHT) w = -1.f;      // impassable connections
-                        myfile << " " << w;
-                    }
-                    myfile << std::endl;
-                }
-            }
-            myfile.close();
+            saveWeights(map_file + ".weights");
         } else {
             // read specifications
             while (getline(file, line)) {
@@ -204,6 +195,27 @@ void Grid::setWeights(const std::vector<float>& weights) {
     this->weights = weights;
 }
 
+void Grid::saveWeights(const std::string& filename) const {
+    if (channels == 0) error("Graph without weights");
+    std::ofstream myfile(filename);
+    myfile << "height " << height << std::endl;
+    myfile << "width " << width << std::endl;
+    myfile << "channels " << channels << std::endl;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (!existNode(x, y)) continue;
+            myfile << x << " " << y;
+            for (int ch = 0; ch < channels; ++ch) {
+                float w = getWeight(x, y, ch);
+                if (w >= MAX_WEIGHT) w = -1.f;      // impassable connections
+                myfile << " " << w;
+            }
+            myfile << std::endl;
+        }
+    }
+    myfile.close();
+}
+
 float Grid::getWeight(int x, int y, int ch) const {
     return weights.at((y * width + x) * channels + ch);
 }
@@ -222,25 +234,22 @@ float Grid::getWeight(Node* const u, Node* const v) const {
 }
 
 int Grid::getNeighbor(const State& s, std::array<State, 4>& buf) const {
-    int cnt = 0;
-    if (s.orientation == -1) {
-        for (auto v : s.node->neighbor) {
-            buf[cnt++] = State(v);
-        }
-    } else {
-        Pos pos;
-        switch (s.orientation) {
-            case 0 : pos = s.node->pos + Pos(0, 1); break;
-            case 1 : pos = s.node->pos - Pos(1, 0); break;
-            case 2 : pos = s.node->pos - Pos(0, 1); break;
-            case 3 : pos = s.node->pos + Pos(1, 0); break;
-            default : error("Unknown agent orientation");
-        }
-        if (existNode(pos.x, pos.y)) buf[cnt++] = State(getNode(pos.x, pos.y), s.orientation);
-        buf[cnt++] = State(s.node, (s.orientation + 1) % 4);
-        buf[cnt++] = State(s.node, (s.orientation + 3) % 4);
-    }
-    return cnt;
+    if (s.orientation == -1) return Omnidirectional::getNeighbor(*this, s, buf);
+    if (s.orientation < 0 || s.orientation > 3) error("Unknown agent orientation");
+    return Oriented::getNeighbor(*this, s, buf);
+}
+
+uint64_t Grid::getHash() const {
+    // FNV-1a over dimensions and occupancy
+    uint64_t h = 0xcbf29ce484222325ULL;
+    auto mix = [&](uint64_t x) {
+        h ^= x;
+        h *= 0x100000001b3ULL;
+    };
+    mix(width);
+    mix(height);
+    for (int id = 0; id < size(); ++id) mix(V[id] != nullptr);
+    return h;
 }
 
 bool Grid::existNode(int id) const {
@@ -251,12 +260,19 @@ bool Grid::existNode(int x, int y) const {
     return 0 <= x && x < width && 0 <= y && y < height && existNode(y * width + x);
 }
 
-std::pair<Path, float> Grid::getPathWithCost(const State& s, const State& g, std::mt19937* MT, const Nodes& prohibited) const {
+std::pair<Path, float> Grid::getPathWithCost(const State& s, const State& g, RNG* rng, const Nodes& prohibited) const {
+    if (s.orientation == -1) return searchPath<Omnidirectional>(s, g, rng, prohibited);
+    if (s.orientation < 0 || s.orientation > 3) error("Unknown agent orientation");
+    return searchPath<Oriented>(s, g, rng, prohibited);
+}
+
+template <typename Motion>
+std::pair<Path, float> Grid::searchPath(const State& s, const State& g, RNG* rng, const Nodes& prohibited) const {
     // shortest cost (weight) path
     if (s == g) return std::make_pair(Path(0), 0.f);
 
     struct AStarNode {
-        State state;
+        PackedState state;
         float g;
         float f;
         int parent;
@@ -271,7 +287,8 @@ std::pair<Path, float> Grid::getPathWithCost(const State& s, const State& g, std
     };
     std::unordered_set<Node*> prohibitedSet(prohibited.begin(), prohibited.end());
     std::priority_queue<int, std::vector<int>, decltype(compare)> OPEN(compare);
-    std::unordered_set<State, State::Hasher> CLOSE;
+    std::unordered_set<uint32_t> CLOSE;     // codes of expanded states, grows with the search only
+    const PackedState goal(g);
 
     int last = -1;
     float cost = -1.f;      // cost of path
@@ -279,27 +296,27 @@ std::pair<Path, float> Grid::getPathWithCost(const State& s, const State& g, std
     OPEN.push(0);
     while (!OPEN.empty()) {
         int idx = OPEN.top(); OPEN.pop();
-        AStarNode& curr = pool[idx];
-        if (CLOSE.find(curr.state) != CLOSE.end()) continue;
-        CLOSE.insert(curr.state);
+        const AStarNode curr = pool[idx];
+        if (!CLOSE.insert(curr.state.code).second) continue;
 
-        if (curr.state == g) {
+        if (curr.state == goal) {
             last = idx;
             cost = curr.g;
             break;
         }
 
         std::array<State, 4> buf;
-        int cnt = getNeighbor(curr.state, buf);
-        if (MT != nullptr) std::shuffle(buf.begin(), buf.begin() + cnt, *MT);
+        State u = getState(curr.state);
+        int cnt = Motion::getNeighbor(*this, u, buf);
+        if (rng != nullptr) randomShuffle(buf.begin(), buf.begin() + cnt, *rng);
         for (int i = 0; i < cnt; ++i) {
-            State next = buf[i];
-            if (CLOSE.find(next) != CLOSE.end()) continue;
-            if (prohibitedSet.count(next.node)) continue;
-            float w = (curr.state.orientation == next.orientation) ? getWeight(curr.state.node, next.node) : 1.f;
+            PackedState next(buf[i]);
+            if (CLOSE.count(next.code)) continue;
+            if (prohibitedSet.count(buf[i].node)) continue;
+            float w = (u.orientation == buf[i].orientation) ? getWeight(u.node, buf[i].node) : 1.f;
             if (w >= MAX_WEIGHT) continue;
             float gcost = curr.g + w;
-            float fcost = gcost + dist(next.node, g.node);
+            float fcost = gcost + dist(buf[i].node, g.node);
             pool.push_back({next, gcost, fcost, idx});
             OPEN.push((int)pool.size() - 1);
         }
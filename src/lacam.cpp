@@ -0,0 +1,240 @@
+#include "lacam.h"
+
+
+template <typename Motion>
+typename LaCAM<Motion>::HNode* LaCAM<Motion>::createNode(const Config& C, HNode* parent) {
+    nodes.emplace_back();
+    HNode* H = &nodes.back();
+    H->C = C;
+    H->parent = parent;
+    H->depth = (parent == nullptr) ? 0 : parent->depth + 1;
+
+    // agents away from their goals gain priority; agents at goals leave, as in PIBT
+    const int N = P->getNum();
+    const Config& goals = P->getConfigGoal();
+    H->priorities.assign(N, 0.f);
+    for (int i = 0; i < N; ++i) {
+        if (C[i].empty() || C[i] == goals[i]) continue;
+        if (parent == nullptr) {
+            H->priorities[i] = (float)pathDist(i, G->getNode(C[i].id())) / N;
+        } else {
+            H->priorities[i] = parent->priorities[i] + 1;
+        }
+        H->order.push_back(i);
+    }
+    std::stable_sort(H->order.begin(), H->order.end(), [&](int i, int j) {
+        return H->priorities[i] > H->priorities[j];
+    });
+    H->tree.push(createConstraint(nullptr, -1, nullptr));
+    explored[C] = H;
+    return H;
+}
+
+template <typename Motion>
+typename LaCAM<Motion>::Constraint* LaCAM<Motion>::createConstraint(Constraint* parent, int i, Node* v) {
+    // constant size; the constrained agents are found by walking up the parents
+    constraints.push_back(Constraint{parent, i, v, (parent == nullptr) ? 0 : parent->depth + 1});
+    return &constraints.back();
+}
+
+template <typename Motion>
+bool LaCAM<Motion>::funcPIBT(const Config& C, int i, int j) {
+    // same preferences as PIBT, on next nodes of agents in configuration C
+    const State curr = G->getState(C[i]);
+    Node* const fwd = Motion::forward(*G, curr);       // nullptr without heading
+    auto compare = [&](Node* const u, Node* const v) {
+        int du = pathDist(i, u);
+        int dv = pathDist(i, v);
+        if (du != dv) return du < dv;
+        if (u == fwd && v != fwd) return true;
+        if (u != fwd && v == fwd) return false;
+        // prefer empty nodes
+        return occupied_now[u->id] == -1 && occupied_now[v->id] != -1;
+    };
+
+    Nodes V;
+    for (auto n : curr.node->neighbor) {
+        if (G->getWeight(curr.node, n) < MAX_WEIGHT) V.push_back(n);
+    }
+    V.push_back(curr.node);
+    RNG rng = RNG(seed, Stream::TIEBREAK).derive(i, generated);
+    randomShuffle(V.begin(), V.end(), rng);
+    std::sort(V.begin(), V.end(), compare);
+
+    for (auto v : V) {
+        if (occupied_next[v->id] != -1) continue;                  // target node not available
+        if (j != -1 && v->id == C[j].id()) continue;               // swap conflict
+        occupied_next[v->id] = i;
+        next[i] = v;
+        int k = occupied_now[v->id];
+        if (k != -1 && next[k] == nullptr) {
+            if (!funcPIBT(C, k, i)) continue;
+        }
+        return true;
+    }
+
+    // no viable move, wait
+    next[i] = curr.node;
+    occupied_next[curr.node->id] = i;
+    return false;
+}
+
+template <typename Motion>
+bool LaCAM<Motion>::advances(int i) {
+    // a move succeeds if the chain of occupants ahead ends at a free node or
+    // closes a cycle of more than two agents; swaps and blocked chains wait
+    if (moving[i] != -1) return moving[i] == 1;
+    std::vector<int> chain;
+    int result = 0;
+    for (int x = i; ; ) {
+        chain.push_back(x);
+        moving[x] = 2;      // visiting
+        int o = occupied_now[next[x]->id];
+        if (o == -1) {
+            result = 1;
+            break;
+        }
+        if (moving[o] == 2) {
+            result = (chain.size() > 2) ? 1 : 0;        // intents are distinct, so the cycle closes at i
+            break;
+        }
+        if (moving[o] != -1) {
+            result = moving[o];
+            break;
+        }
+        x = o;
+    }
+    for (auto x : chain) moving[x] = result;
+    return result == 1;
+}
+
+template <typename Motion>
+bool LaCAM<Motion>::generate(HNode* H, const Constraint* L, Config& Q) {
+    ++generated;
+    const Config& C = H->C;
+    const int N = P->getNum();
+    next.assign(N, nullptr);
+    for (auto i : H->order) occupied_now[C[i].id()] = i;
+
+    bool success = true;
+    // constrained agents take their next nodes first
+    for (const Constraint* c = L; c->parent != nullptr && success; c = c->parent) {
+        if (occupied_next[c->where->id] != -1) {
+            success = false;
+        } else {
+            next[c->who] = c->where;
+            occupied_next[c->where->id] = c->who;
+        }
+    }
+    for (int k = 0; k < (int)H->order.size() && success; ++k) {
+        const int i = H->order[k];
+        if (next[i] == nullptr && !funcPIBT(C, i)) success = false;
+    }
+    for (const Constraint* c = L; c->parent != nullptr && success; c = c->parent) {
+        if (occupied_next[c->where->id] != c->who) success = false;      // displaced by a waiting agent
+    }
+
+    if (success) {
+        // next nodes to actions, as PIBT executes them
+        const Config& goals = P->getConfigGoal();
+        std::vector<Action> actions(N, Action::NONE);
+        moving.assign(N, 0);
+        for (auto i : H->order) {
+            actions[i] = Motion::getAction(G->getState(C[i]), next[i], G->getState(goals[i]));
+            if (actions[i] == Action::NONE) error("Agent intent to make an invalid move");
+            if (actions[i] == Action::MOVE) moving[i] = -1;
+        }
+        Q.assign(N, PackedState());        // agents at goals leave
+        for (auto i : H->order) {
+            Q[i] = C[i];
+            const State s = G->getState(C[i]);
+            switch (actions[i]) {
+                case Action::TURN_LEFT : Q[i] = State(s.node, Heading::LEFT[s.orientation]); break;
+                case Action::TURN_RIGHT : Q[i] = State(s.node, Heading::RIGHT[s.orientation]); break;
+                case Action::MOVE : if (advances(i)) Q[i] = State(next[i], s.orientation); break;
+                default : break;
+            }
+        }
+    }
+
+    for (auto i : H->order) {
+        occupied_now[C[i].id()] = -1;
+        if (next[i] != nullptr) occupied_next[next[i]->id] = -1;
+    }
+    return success;
+}
+
+template <typename Motion>
+void LaCAM<Motion>::backtrack(HNode* H) {
+    std::vector<HNode*> path;
+    for (; H != nullptr; H = H->parent) path.push_back(H);
+    for (auto itr = path.rbegin(); itr != path.rend(); ++itr) solution.add((*itr)->C);
+}
+
+template <typename Motion>
+void LaCAM<Motion>::run() {
+    info("Running LaCAM...");
+
+    nodes.clear();
+    constraints.clear();
+    explored.clear();
+    generated = 0;
+    solved = false;
+    std::vector<HNode*> OPEN;       // depth-first
+    OPEN.push_back(createNode(P->getConfigStart(), nullptr));
+    bool interrupted = false;
+    while (!OPEN.empty()) {
+        if (overCompTime()) {
+            warn("Exceeded maximum computation time limit");
+            interrupted = true;
+            break;
+        } else if (stopRequested()) {
+            info("Stopped on request after " + std::to_string(explored.size()) + " configurations");
+            interrupted = true;
+            break;
+        }
+
+        HNode* H = OPEN.back();
+        if (H->order.empty()) {
+            backtrack(H);
+            solved = true;
+            break;
+        }
+        if (H->tree.empty()) {
+            OPEN.pop_back();
+            continue;
+        }
+
+        // extend the constraint tree lazily, one agent per level
+        Constraint* L = H->tree.front();
+        H->tree.pop();
+        if (L->depth < (int)H->order.size()) {
+            const int i = H->order[L->depth];
+            Node* u = G->getNode(H->C[i].id());
+            Nodes V;
+            for (auto v : u->neighbor) {
+                if (G->getWeight(u, v) < MAX_WEIGHT) V.push_back(v);
+            }
+            V.push_back(u);
+            RNG rng = RNG(seed, Stream::SEARCH).derive(i, generated);
+            randomShuffle(V.begin(), V.end(), rng);
+            for (auto v : V) H->tree.push(createConstraint(L, i, v));
+        }
+
+        if (H->depth >= max_timestep) continue;
+        Config Q;
+        if (!generate(H, L, Q)) continue;
+        if (explored.find(Q) != explored.end()) continue;
+        OPEN.push_back(createNode(Q, H));
+    }
+    if (!solved && !interrupted) warn("No solution within " + std::to_string(max_timestep) + " timesteps");
+    num_explored = (int)explored.size();
+
+    // release search memory, the plan is all that is kept
+    nodes.clear();
+    constraints.clear();
+    explored.clear();
+}
+
+template class LaCAM<Omnidirectional>;
+template class LaCAM<Oriented>;
@@ -0,0 +1,24 @@
+#include "lifelong.h"
+
+
+void GoalQueue::push(const State& goal) {
+    std::lock_guard<std::mutex> lock(mtx);
+    goals.push_back(goal);
+}
+
+bool GoalQueue::pop(State& goal) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (goals.empty()) return false;
+    goal = goals.front();
+    goals.pop_front();
+    return true;
+}
+
+size_t GoalQueue::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return goals.size();
+}
+
+GoalProvider GoalQueue::provider() {
+    return [this](int, int, State& goal) {return pop(goal);};
+}
@@ -0,0 +1,204 @@
+#include "lns.h"
+#include "pibt.h"
+
+
+template <typename Motion>
+LNS<Motion>::LNS(MAPF_Instance* P) :
+    MAPF_Solver(P),
+    initial(std::make_unique<PIBT<Motion>>(P)),
+    table(G),
+    neighborhood_size(8),
+    iterations(0),
+    lower_bound(0) {
+        solver_name = "LNS";
+        weights.fill(1.f);
+    }
+
+template <typename Motion>
+void LNS<Motion>::setInitialSolver(std::unique_ptr<MAPF_Solver> solver) {
+    if (solver == nullptr || solver->getP() != P) error("Initial solver must solve the same instance");
+    initial = std::move(solver);
+}
+
+template <typename Motion>
+bool LNS<Motion>::findPath(const int i, Path& path) {
+    SpaceTimeAStar<Motion> search(G, table);
+    return search.findPath(P->getConfigStart()[i], P->getConfigGoal()[i],
+        [&](Node* v) {return steps[i][v->id];}, max_timestep, path,
+        [&]() {return overCompTime() || stopRequested();});
+}
+
+template <typename Motion>
+std::vector<int> LNS<Motion>::selectNeighborhood(Neighborhood type, RNG& rng) {
+    const int N = P->getNum();
+    const int k = std::min(neighborhood_size, N);
+    std::vector<int> agents;
+    std::vector<bool> chosen(N, false);
+    auto add = [&](int j) {
+        if (chosen[j] || (int)agents.size() >= k) return;
+        chosen[j] = true;
+        agents.push_back(j);
+    };
+
+    switch (type) {
+        case Neighborhood::RANDOM : {
+            while ((int)agents.size() < k) add(getRandomInt(0, N - 1, rng));
+            break;
+        }
+        case Neighborhood::CONGESTION : {
+            // agents passing through the region around a visited node
+            int a = getRandomInt(0, N - 1, rng);
+            PackedState s = paths[a][getRandomInt(0, (int)paths[a].size() - 1, rng)];
+            if (s.empty()) break;
+            std::vector<bool> region(G->size(), false);
+            std::queue<Node*> OPEN;
+            OPEN.push(G->getNode(s.id()));
+            region[s.id()] = true;
+            for (int cnt = 1; !OPEN.empty() && cnt < 4 * k; OPEN.pop()) {
+                for (auto v : OPEN.front()->neighbor) {
+                    if (region[v->id] || cnt >= 4 * k) continue;
+                    region[v->id] = true;
+                    OPEN.push(v);
+                    ++cnt;
+                }
+            }
+            add(a);
+            std::vector<int> order(N);
+            std::iota(order.begin(), order.end(), 0);
+            randomShuffle(order.begin(), order.end(), rng);
+            for (auto j : order) {
+                if ((int)agents.size() >= k) break;
+                for (auto& q : paths[j]) {
+                    if (!q.empty() && region[q.id()]) {
+                        add(j);
+                        break;
+                    }
+                }
+            }
+            break;
+        }
+        case Neighborhood::BLOCKING : {
+            // agents on the shortest path of a delayed agent while it could have passed
+            int a = -1, delay = 0;
+            for (int r = 0; r < 8; ++r) {
+                int j = getRandomInt(0, N - 1, rng);
+                int d = (int)paths[j].size() - 1 - pathDist(j);
+                if (d > delay) {
+                    a = j;
+                    delay = d;
+                }
+            }
+            if (a == -1) return selectNeighborhood(Neighborhood::RANDOM, rng);
+            add(a);
+            Node* u = G->getNode(P->getConfigStart()[a].id());
+            Node* const g = G->getNode(P->getConfigGoal()[a].id());
+            for (int step = 0; (int)agents.size() < k; ++step) {
+                for (int t = step; t <= step + delay; ++t) {
+                    int o = table.occupant(t, u->id);
+                    if (o != -1) add(o);
+                }
+                if (u == g) break;
+                Node* next = nullptr;
+                for (auto v : u->neighbor) {
+                    if (pathDist(a, v) < pathDist(a, u)) {
+                        next = v;
+                        break;
+                    }
+                }
+                if (next == nullptr) break;
+                u = next;
+            }
+            break;
+        }
+    }
+    return agents;
+}
+
+template <typename Motion>
+void LNS<Motion>::run() {
+    info("Running LNS...");
+
+    initial->shareDistanceTable(distance_table);
+    initial->solve();
+    iterations = 0;
+    timeline.clear();
+    table.clear();
+    if (!initial->succeed()) {
+        warn("Initial solver " + initial->getSolverName() + " failed; Nothing to refine");
+        solution.assign(initial->getSolution());
+        return;
+    }
+
+    const int N = P->getNum();
+    steps.resize(N);
+    for (int i = 0; i < N; ++i) computeSteps(steps[i], P->getGoal(i).node);
+    const Plan& plan = initial->getSolution();
+    paths.assign(N, Path());
+    for (int i = 0; i < N; ++i) {
+        paths[i] = plan.getPath(i);
+        table.reserve(i, paths[i]);
+    }
+    int soc = plan.getSOC();
+    const int soc_initial = soc;
+    // weighted rows may count more steps than needed, so the bound uses the fewest steps
+    lower_bound = 0;
+    for (int i = 0; i < N; ++i) lower_bound += steps[i][P->getStart(i).node->id];
+    const int lb = lower_bound;
+    timeline.emplace_back(getSolverElapsedTime(), soc);
+
+    RNG rng(seed, Stream::SEARCH);
+    weights.fill(1.f);
+    while (soc > lb && !overCompTime() && !stopRequested()) {
+        ++iterations;
+        // roulette over neighborhoods, weighted by recent improvements
+        float r = getRandomFloat(0, weights[0] + weights[1] + weights[2], rng);
+        int type = 0;
+        for (; type < 2 && r >= weights[type]; ++type) r -= weights[type];
+        std::vector<int> agents = selectNeighborhood(static_cast<Neighborhood>(type), rng);
+        if (agents.size() < 2) continue;
+
+        std::vector<Path> old;
+        int old_cost = 0;
+        for (auto a : agents) {
+            old.push_back(paths[a]);
+            old_cost += (int)paths[a].size() - 1;
+            table.release(a, paths[a]);
+        }
+        std::vector<int> order(agents.size());
+        std::iota(order.begin(), order.end(), 0);
+        randomShuffle(order.begin(), order.end(), rng);
+        int new_cost = 0;
+        int planned = 0;
+        for (auto k : order) {
+            Path path;
+            if (!findPath(agents[k], path)) break;
+            paths[agents[k]] = path;
+            table.reserve(agents[k], path);
+            new_cost += (int)path.size() - 1;
+            ++planned;
+        }
+
+        if (planned == (int)agents.size() && new_cost < old_cost) {
+            soc -= old_cost - new_cost;
+            timeline.emplace_back(getSolverElapsedTime(), soc);
+            weights[type] = 0.9f * weights[type] + 0.1f * (old_cost - new_cost);
+        } else {
+            for (int j = 0; j < planned; ++j) table.release(agents[order[j]], paths[agents[order[j]]]);
+            for (int j = 0; j < (int)agents.size(); ++j) {
+                paths[agents[j]] = old[j];
+                table.reserve(agents[j], paths[agents[j]]);
+            }
+            weights[type] = std::max(0.01f, 0.9f * weights[type]);
+        }
+    }
+
+    addPaths(paths);
+    solved = true;
+    table.clear();
+    steps.clear();
+    info("Improved soc from " + std::to_string(soc_initial) + " to " + std::to_string(soc)
+        + " in " + std::to_string(iterations) + " iterations (lower bound " + std::to_string(lb) + ")");
+}
+
+template class LNS<Omnidirectional>;
+template class LNS<Oriented>;
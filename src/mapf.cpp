@@ -0,0 +1,90 @@
+#include "mapf.h"
+#include "lacam.h"
+#include "lns.h"
+#include "pibt.h"
+#include "portfolio.h"
+#include "pp.h"
+#include "tswap.h"
+
+
+void setLogger(bool enabled, bool log){
+    Logger::get().setVerbose(enabled);
+    if (log) {
+        Logger::get().enableFileLogging("output.log");
+    } else {
+        Logger::get().disableFileLogging();
+    }
+}
+
+Grid* make_graph(const Parameters& params) {
+    setLogger(params.verbose, params.log);
+    Grid *G = new Grid(params.map, params.with_weights);
+    return G;
+}
+
+MAPF_Instance* make_instance(Grid* G, const Parameters& params) {
+    MAPF_Instance* P = new MAPF_Instance(G, params.seed, params.max_timestep, params.max_comp_time);
+    return P;
+}
+
+template <template <typename> class Solver, typename Setup>
+MAPF_Solver* make_solver_for(MAPF_Instance* P, Setup setup) {
+    // pick instantiation for motion model of agents
+    switch (P->getMotionModel()) {
+        case MotionModel::OMNIDIRECTIONAL : {
+            auto solver = new Solver<Omnidirectional>(P);
+            setup(solver);
+            return solver;
+        }
+        case MotionModel::ORIENTED : {
+            auto solver = new Solver<Oriented>(P);
+            setup(solver);
+            return solver;
+        }
+        default : break;
+    }
+    throw MAPFError("Agents with and without heading cannot be mixed");
+}
+
+MAPF_Solver* make_solver(MAPF_Instance* P, const Parameters& params) {
+    if (params.solver == "PIBT") {
+        return make_solver_for<PIBT>(P, [&](auto* solver) {
+            if (params.stall_window > 0) solver->setStallWindow(params.stall_window);
+            solver->setMaxRecoveries(params.max_recoveries);
+            solver->setNumThreads(params.num_threads);
+            solver->setTileSize(params.tile_size);
+        });
+    }
+    if (params.solver == "LACAM") {
+        return make_solver_for<LaCAM>(P, [](auto*) {});
+    }
+    if (params.solver == "PP") {
+        return make_solver_for<PrioritizedPlanning>(P, [&](auto* solver) {
+            solver->setMaxRestarts(params.pp_max_restarts);
+        });
+    }
+    if (params.solver == "TSWAP") {
+        return make_solver_for<TSWAP>(P, [](auto*) {});
+    }
+    if (params.solver == "LNS") {
+        Parameters initial = params;
+        initial.solver = params.lns_initial;
+        if (initial.solver == "LNS") throw MAPFError("LNS cannot refine its own solutions");
+        return make_solver_for<LNS>(P, [&](auto* solver) {
+            solver->setInitialSolver(std::unique_ptr<MAPF_Solver>(make_solver(P, initial)));
+            solver->setNeighborhoodSize(params.lns_neighborhood_size);
+        });
+    }
+    if (params.solver == "PORTFOLIO") {
+        // PIBT with distinct tie-breaking streams; the first member keeps the base seed
+        std::vector<std::unique_ptr<MAPF_Solver>> members;
+        Parameters member = params;
+        member.solver = "PIBT";
+        for (int k = 0; k < std::max(1, params.portfolio_size); ++k) {
+            members.emplace_back(make_solver(P, member));
+            members.back()->setSeed(P->getSeed() + k);
+        }
+        return new Portfolio(P, std::move(members), Portfolio::parseMode(params.portfolio_mode));
+    }
+    throw MAPFError("Unknown solver selected");
+}
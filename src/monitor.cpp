@@ -0,0 +1,65 @@
+#include "monitor.h"
+
+
+ProgressMonitor::ProgressMonitor(int num_agents, int window) :
+    window(window),
+    best_dist(num_agents, INT_MAX),
+    last_improved(num_agents, 0),
+    last_progress(0) {
+        if (window <= 0) error("Progress window must be positive");
+    }
+
+void ProgressMonitor::reset(int timestep) {
+    // forget recent history, e.g. after a recovery attempt
+    std::fill(last_improved.begin(), last_improved.end(), timestep);
+    last_progress = timestep;
+    history.clear();
+    counts.clear();
+}
+
+void ProgressMonitor::retarget(int i, int timestep) {
+    best_dist[i] = INT_MAX;
+    last_improved[i] = timestep;
+    last_progress = timestep;
+}
+
+void ProgressMonitor::observe(int i, int d, int timestep) {
+    if (d < best_dist[i]) {
+        best_dist[i] = d;
+        last_improved[i] = timestep;
+        last_progress = timestep;
+    }
+}
+
+void ProgressMonitor::record(const Config& config) {
+    // keep hashes of configurations within the window
+    size_t h = hash(config);
+    history.push_back(h);
+    ++counts[h];
+    if ((int)history.size() > window) {
+        auto itr = counts.find(history.front());
+        if (--(itr->second) == 0) counts.erase(itr);
+        history.pop_front();
+    }
+}
+
+bool ProgressMonitor::stalled(int timestep) const {
+    return timestep - last_progress >= window;
+}
+
+std::vector<int> ProgressMonitor::getStalledAgents(int timestep) const {
+    std::vector<int> ids;
+    for (int i = 0; i < (int)best_dist.size(); ++i) {
+        if (best_dist[i] == 0) continue;        // reached goal node
+        if (timestep - last_improved[i] >= window) ids.push_back(i);
+    }
+    return ids;
+}
+
+size_t ProgressMonitor::hash(const Config& config) {
+    size_t h = config.size();
+    for (auto& s : config) {
+        h ^= PackedState::Hasher()(s) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
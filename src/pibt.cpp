@@ -1,25 +1,19 @@
 #include "pibt.h"
 
 
-bool PIBT::funcPIBT(Agent* a, Agent* b) {
+template <typename Motion>
+bool PIBT<Motion>::funcPIBT(Agent* a, Agent* b, Tile* tile) {
+    Node* const fwd = Motion::forward(*G, a->curr);       // nullptr without heading
     auto compare = [&](Node* const u, Node* const v) {
         int du = pathDist(a->id, u);        // distance-to-goal
         int dv = pathDist(a->id, v);        // distance-to-goal
         if (du != dv) return du < dv;
 
         // prefer forward movement
-        Pos pos;
-        switch (a->curr.orientation) {
-            case 0 : pos = a->curr.node->pos + Pos(0, 1); break;
-            case 1 : pos = a->curr.node->pos - Pos(1, 0); break;
-            case 2 : pos = a->curr.node->pos - Pos(0, 1); break;
-            case 3 : pos = a->curr.node->pos + Pos(1, 0); break;
-            default : error("Unknown agent orientation");
-        }
-        if (u->pos == pos && v->pos != pos) {
+        if (u == fwd && v != fwd) {
             return true;
         }
-        if (u->pos != pos && v->pos == pos) {
+        if (u != fwd && v == fwd) {
             return false;
         }
 
@@ -40,17 +34,27 @@ bool PIBT::funcPIBT(Agent* a, Agent* b) {
         }
     }
     V.push_back(a->curr.node);
-    std::shuffle(V.begin(), V.end(), *MT);
+    RNG rng = RNG(seed, Stream::TIEBREAK).derive(a->id, timestep);
+    randomShuffle(V.begin(), V.end(), rng);
     std::sort(V.begin(), V.end(), compare);     // ranking preference
 
     for (auto v : V) {
         if (occupied_next[v->id] != nullptr) continue;      // target node not available
         if (b != nullptr && v == b->curr.node) continue;    // swap conflict
+        auto k = occupied_now[v->id];
+        if (tile != nullptr && k != nullptr && k->next == nullptr && !interior[v->id]) {
+            // pushing an agent on the tile border is left to the serial phase
+            tile->escalated = true;
+            return false;
+        }
         occupied_next[v->id] = a;
         a->next = v;
-        auto k = occupied_now[v->id];
+        if (tile != nullptr) tile->planned.push_back(a);
         if (k != nullptr && k->next == nullptr) {
-            if (!funcPIBT(k, a)) continue;
+            if (!funcPIBT(k, a, tile)) {
+                if (tile != nullptr && tile->escalated) return false;
+                continue;
+            }
         }
         return true;
     }
@@ -58,67 +62,103 @@ bool PIBT::funcPIBT(Agent* a, Agent* b) {
     // no viable move, wait
     a->next = a->curr.node;
     occupied_next[a->next->id] = a;
+    if (tile != nullptr) tile->planned.push_back(a);
     return false;
 }
 
-Action PIBT::getAction(const State& curr, Node* const next, const State& goal) const {
-    if (curr.node == nullptr || next == nullptr || goal.node == nullptr) {
-        error("Failed to retrieve agent action");
+template <typename Motion>
+void PIBT<Motion>::setNumThreads(const int n) {
+    num_threads = (n > 0) ? n : (int)std::max(1u, std::thread::hardware_concurrency());
+    if (num_threads > 1) {
+        if (workers == nullptr || workers->size() != num_threads) workers = std::make_unique<WorkerPool>(num_threads);
+    } else {
+        workers.reset();
     }
-    if (next == curr.node) {
-        if (next == goal.node){
-            // agent is at goal, rotate to face target orientation
-            int dtheta = (goal.orientation - curr.orientation + 4) % 4;
-            if (dtheta == 1 || dtheta  == 2) {
-                return Action::TURN_LEFT;
-            } else {
-                return Action::TURN_RIGHT;
-            }
+}
+
+template <typename Motion>
+void PIBT<Motion>::setTileSize(const int w) {
+    if (w < 2) error("Tiles must be at least 2 cells wide");
+    tile_size = w;
+    tile_of.clear();
+}
+
+template <typename Motion>
+void PIBT<Motion>::partition() {
+    const int cols = (G->getWidth() + tile_size - 1) / tile_size;
+    const int rows = (G->getHeight() + tile_size - 1) / tile_size;
+    tile_of.resize(G->size());
+    interior.assign(G->size(), true);
+    for (int k = 0; k < G->size(); ++k) {
+        tile_of[k] = (k / G->getWidth() / tile_size) * cols + (k % G->getWidth()) / tile_size;
+    }
+    for (int k = 0; k < G->size(); ++k) {
+        if (G->getNode(k) == nullptr) continue;
+        for (auto v : G->getNode(k)->neighbor) {
+            if (tile_of[v->id] != tile_of[k]) interior[k] = false;
         }
-        return Action::WAIT;
-    }
-    if (curr.orientation == -1) return Action::MOVE;
-
-    int target;
-    if (next->pos == curr.node->pos + Pos(0, 1)) {
-        target = 0;
-    } else if (next->pos == curr.node->pos - Pos(1, 0)) {
-        target = 1;
-    } else if (next->pos == curr.node->pos - Pos(0, 1)) {
-        target = 2;
-    } else if (next->pos == curr.node->pos + Pos(1, 0)) {
-        target = 3;
-    } else {
-        error("Agent intent to make an invalid move");
     }
-    if (curr.orientation == target) {
-        return Action::MOVE;
-    } else {
-        int dtheta = (target - curr.orientation + 4) % 4;
-        if (dtheta == 1 || dtheta == 2) {
-            return Action::TURN_LEFT;
-        } else {
-            return Action::TURN_RIGHT;
+    tiles.assign(cols * rows, Tile());
+}
+
+template <typename Motion>
+void PIBT<Motion>::planTiles() {
+    // tiles touch disjoint nodes and agents, so their plans do not depend on
+    // the schedule; workers pull the next tile, which balances crowded tiles
+    if (tile_of.empty()) partition();
+    for (auto& tile : tiles) tile.agents.clear();
+    for (auto a : A) {
+        if (a->done || a->next != nullptr) continue;
+        const int k = a->curr.node->id;
+        if (interior[k]) tiles[tile_of[k]].agents.push_back(a);
+    }
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t k = next++; k < tiles.size(); k = next++) {
+            Tile& tile = tiles[k];
+            for (auto a : tile.agents) {
+                if (a->next != nullptr) continue;
+                tile.planned.clear();
+                tile.escalated = false;
+                funcPIBT(a, nullptr, &tile);
+                if (!tile.escalated) continue;
+                // the whole chain waits for the border phase, as if never planned
+                for (auto b : tile.planned) occupied_next[b->next->id] = nullptr;
+                for (auto b : tile.planned) b->next = nullptr;
+            }
         }
+    };
+    workers->run(worker);
+}
+
+template <typename Motion>
+Action PIBT<Motion>::getAction(const State& curr, Node* const next, const State& goal) const {
+    if (curr.node == nullptr || next == nullptr || goal.node == nullptr) {
+        error("Failed to retrieve agent action");
     }
+    Action action = Motion::getAction(curr, next, goal);
+    if (action == Action::NONE) error("Agent intent to make an invalid move");
+    return action;
 }
 
-void PIBT::wait(Agent* a, Config& config) {
+template <typename Motion>
+void PIBT<Motion>::wait(Agent* a, Config& config) {
     if (occupied_next[a->next->id] != a) error("Inconsistent plan");
     occupied_next[a->next->id] = nullptr;
     a->next = nullptr;
     config[a->id] = a->curr;
 }
 
-void PIBT::turn(Agent* a, const Actions& actions, Config& config) {
+template <typename Motion>
+void PIBT<Motion>::turn(Agent* a, const Actions& actions, Config& config) {
     if (occupied_next[a->next->id] != a) error("Inconsistent plan");
     occupied_next[a->next->id] = nullptr;
     a->next = nullptr;
-    int h;
+    int h = a->curr.orientation;
     if (actions[a->id] == Action::TURN_LEFT) {
-        h = (a->curr.orientation + 1) % 4;
+        h = Heading::LEFT[h];
     } else if (actions[a->id] == Action::TURN_RIGHT) {
-        h = (a->curr.orientation + 3) % 4;
+        h = Heading::RIGHT[h];
     } else {
         error("Incorrect action resolution");
     }
@@ -126,138 +166,483 @@ void PIBT::turn(Agent* a, const Actions& actions, Config& config) {
     config[a->id] = a->curr;
 }
 
-bool PIBT::move(Agent* a, const Actions& actions, Config& config) {
+template <typename Motion>
+void PIBT<Motion>::advance(Agent* a, Config& config) {
     if (occupied_next[a->next->id] != a) error("Inconsistent plan");
-    
-    if (occupied_now[a->next->id] == nullptr) {
-        // target node is available, move
-        if (occupied_now[a->curr.node->id] != a) error("Inconsistent plan");
+    if (occupied_now[a->next->id] != nullptr) error("Inconsistent plan");
+    // release current node unless it has already been taken over within a cycle
+    if (occupied_now[a->curr.node->id] == a) occupied_now[a->curr.node->id] = nullptr;
+    occupied_now[a->next->id] = a;
+    int h = a->curr.orientation;
+    a->curr = State(a->next, h);
+    occupied_next[a->next->id] = nullptr;
+    a->next = nullptr;
+    config[a->id] = a->curr;
+}
+
+template <typename Motion>
+void PIBT<Motion>::rotate(const Agents& cycle, Config& config) {
+    // every node of the cycle is vacated and re-entered within the same timestep
+    for (auto a : cycle) {
+        if (occupied_next[a->next->id] != a) error("Inconsistent plan");
         occupied_now[a->curr.node->id] = nullptr;
-        occupied_now[a->next->id] = a;
-        int h = a->curr.orientation;
-        a->curr = State(a->next, h);
-        occupied_next[a->next->id] = nullptr;
-        a->next = nullptr;
-        config[a->id] = a->curr;
-        return true;
-    } else {
-        // target node is currently occupied, verify
-        auto b = occupied_now[a->next->id];
-        if (actions[b->id] != Action::MOVE || b->next == nullptr) {
-            // other agent does not intent to move, or already moved
+    }
+    for (auto a : cycle) advance(a, config);
+}
+
+template <typename Motion>
+void PIBT<Motion>::resolve(const Agents& A, const Actions& actions, Config& config) {
+    // agents staying in place are settled first, so that every remaining move
+    // depends on at most one other agent (the current occupant of its target)
+    for (auto a : A) {
+        if (a->done) continue;
+        if (actions[a->id] == Action::WAIT) {
             wait(a, config);
-            return false;
-        } else if (actions[b->id] == Action::MOVE && b->next != nullptr) {
-            // move other agent
-            if (occupied_now[a->curr.node->id] != a) error("Inconsistent plan");
-            occupied_now[a->curr.node->id] = nullptr;       // temporarily release current node
-            if (!move(b, actions, config)) {
-                // other agent failed to move, wait
-                occupied_now[a->curr.node->id] = a;
-                wait(a, config);
-                return false;
+        } else if (actions[a->id] == Action::TURN_LEFT || actions[a->id] == Action::TURN_RIGHT) {
+            turn(a, actions, config);
+        } else if (actions[a->id] != Action::MOVE) {
+            error("Unknown agent action");
+        }
+    }
+
+    // dependencies form disjoint chains and cycles; resolve them in priority order
+    std::vector<bool> visiting(P->getNum(), false);
+    Agents chain;
+    for (auto a : A) {
+        if (a->done) continue;
+        if (a->next == nullptr) continue;       // already updated
+        chain.clear();
+        int k = -1;     // index in chain where a cycle closes
+        for (Agent* x = a; ; ) {
+            chain.push_back(x);
+            visiting[x->id] = true;
+            auto b = occupied_now[x->next->id];
+            if (b == nullptr) break;                // target node is free
+            if (visiting[b->id]) {
+                k = std::find(chain.begin(), chain.end(), b) - chain.begin();
+                break;
             }
-            // other agent moved, move
-            if (occupied_now[a->next->id] != nullptr) error("Inconsistent plan");
-            occupied_now[a->next->id] = a;
-            int h = a->curr.orientation;
-            a->curr = State(a->next, h);
-            occupied_next[a->next->id] = nullptr;
-            a->next = nullptr;
-            config[a->id] = a->curr;
-            return true;
+            if (b->next == nullptr) break;          // other agent stays in place
+            x = b;
+        }
+
+        int tail = (int)chain.size();
+        if (k != -1 && tail - k > 2) {
+            // closed cycle of agents, advance all at once
+            rotate(Agents(chain.begin() + k, chain.end()), config);
+            tail = k;
         }
+        // unwind chain from its head; swaps (2-cycles) are left to wait
+        for (int j = tail - 1; j >= 0; --j) {
+            auto x = chain[j];
+            if (occupied_now[x->next->id] == nullptr) {
+                advance(x, config);
+            } else {
+                wait(x, config);
+            }
+        }
+        for (auto x : chain) visiting[x->id] = false;
     }
-    return false;
 }
 
-void PIBT::run() {
-    info("Running PIBT...");
-    auto compare = [](Agent* a, Agent* b) {
-        if (a->elapsed != b->elapsed) return a->elapsed > b->elapsed;           // priority based on elapsed time
-        if (a->init_dist != b->init_dist) return a->init_dist > b->init_dist;   // priority based on initial distance-to-goal
-        return a->epsilon > b->epsilon;
-    };
+template <typename Motion>
+bool PIBT<Motion>::comparePriority(Agent* const a, Agent* const b) {
+    if (a->elapsed != b->elapsed) return a->elapsed > b->elapsed;           // priority based on elapsed time
+    if (a->init_dist != b->init_dist) return a->init_dist > b->init_dist;   // priority based on initial distance-to-goal
+    return a->epsilon > b->epsilon;
+}
+
+template <typename Motion>
+void PIBT<Motion>::recover(Agents& A, const std::vector<int>& stalled) {
+    // raise priority of stalled agents and redraw tie-breakers
+    for (auto a : A) {
+        if (a->done) continue;
+        if (std::binary_search(stalled.begin(), stalled.end(), a->id)) a->elapsed += stall_window;
+        RNG rng = RNG(seed, Stream::PRIORITY).derive(a->id, timestep);
+        a->epsilon = getRandomFloat(0, 1, rng);
+    }
+    std::sort(A.begin(), A.end(), comparePriority);
+}
 
-    Agents A;
+template <typename Motion>
+void PIBT<Motion>::initAgents() {
+    pool.clear();
+    pool.reserve(P->getNum());
+    A.clear();
     std::fill(occupied_now.begin(), occupied_now.end(), nullptr);
     std::fill(occupied_next.begin(), occupied_next.end(), nullptr);
-    // initialize
     for (int i = 0;i < P->getNum(); ++i) {
         State s = P->getStart(i);
         State g = P->getGoal(i);
         int init_dist = distance_initialized ? pathDist(i) : 0;
-        Agent* a = new Agent{i, s, nullptr, g, 0, init_dist, getRandomFloat(0, 1, *MT), false};
+        RNG rng = RNG(seed, Stream::PRIORITY).derive(i);
+        pool.push_back(Agent{i, s, nullptr, g, 0, init_dist, getRandomFloat(0, 1, rng), false, false});
+        Agent* a = &pool.back();
         A.push_back(a);
         occupied_now[a->curr.node->id] = a;
     }
-    solution.add(P->getConfigStart());
-    int timestep = 0;
+    if (recording) solution.add(P->getConfigStart());
+    timestep = 0;
+    recoveries = 0;
+    monitor = ProgressMonitor(P->getNum(), stall_window);
+    for (auto a : A) monitor.observe(a->id, pathDist(a->id, a->curr.node), timestep);
+    std::sort(A.begin(), A.end(), comparePriority);     // sort agents by priority
+    resort = false;
+    solved = false;
+    tasks_completed = 0;
+    last_step_time = 0;
+    max_step_time = 0;
+    overruns = 0;
+    revision = P->getRevision();
+    initialized = true;
+}
 
-    std::sort(A.begin(), A.end(), compare);     // sort agents by priority
-    while (true) {
-        for (auto a : A) {
-            if (a->done) continue;
-            if (a->next == nullptr) {
-                funcPIBT(a);
-            }
+template <typename Motion>
+typename PIBT<Motion>::Status PIBT<Motion>::update(Config& config) {
+    if (resort) {
+        std::sort(A.begin(), A.end(), comparePriority);
+        resort = false;
+    }
+    if (num_threads > 1) planTiles();
+    for (auto a : A) {
+        if (a->done) continue;
+        if (a->next == nullptr) {
+            funcPIBT(a);
         }
+    }
 
-        // convert PIBT solution to actions
-        Actions actions(P->getNum(), Action::NONE);
-        for (auto a : A) {
-            if (a->done) continue;
-            actions[a->id] = getAction(a->curr, a->next, a->goal);
-        }
+    // convert PIBT solution to actions
+    Actions actions(P->getNum(), Action::NONE);
+    for (auto a : A) {
+        if (a->done) continue;
+        actions[a->id] = getAction(a->curr, a->next, a->goal);
+    }
 
-        // update configs
-        Config config(P->getNum());
-        for (auto a : A) {
-            if (a->done) continue;
-            if (a->next == nullptr) continue;       // already updated
-            if (actions[a->id] == Action::WAIT) {
-                wait(a, config);
-                a->elapsed += 1;
-            } else if (actions[a->id] == Action::TURN_LEFT || actions[a->id] == Action::TURN_RIGHT) {
-                turn(a, actions, config);
-                a->elapsed += 1;
-            } else if (actions[a->id] == Action::MOVE) {
-                move(a, actions, config);
-                a->elapsed += 1;
-            } else {
-                error("Unknown agent action");
+    // update configs
+    config.assign(P->getNum(), PackedState());
+    resolve(A, actions, config);
+    for (auto a : A) {
+        if (a->done || a->idle) continue;
+        a->elapsed += 1;
+    }
+    if (recording && !lookahead) solution.add(config);
+    ++timestep;
+
+    bool done = true;
+    bool waiting = true;        // all remaining agents are out of tasks
+    for (auto a : A) {
+        if (a->done) continue;
+        if (a->idle || a->curr == a->goal) {
+            if (!a->idle) ++tasks_completed;
+            State g;
+            if (goal_provider && !lookahead && goal_provider(a->id, timestep, g)) {
+                retarget(a, g);
+                done = false;
+                waiting = false;
+                continue;
             }
-        }
-        solution.add(config);
-
-        bool done = true;
-        for (auto a : A) {
-            if (a->done) continue;
-            if (a->curr == a->goal) {
-                // remove agent
-                if (occupied_now[a->curr.node->id] != a) error("Inconsistent plan");
-                occupied_now[a->curr.node->id] = nullptr;
-                a->done = true;
+            if (goal_provider) {
+                // lifelong agents stay on the map and ask again on the next step
+                a->idle = true;
+                a->elapsed = 0;
+                done = false;
+                continue;
             }
-            done &= a->done;
+            // remove agent
+            if (occupied_now[a->curr.node->id] != a) error("Inconsistent plan");
+            occupied_now[a->curr.node->id] = nullptr;
+            a->done = true;
         }
-        ++timestep;
-        if (done) {
-            solved = true;
+        done &= a->done;
+        waiting = false;
+    }
+    if (done) {
+        solved = true;
+        return Status::SOLVED;
+    }
+    if (waiting) {
+        // nothing to make progress on until the provider issues tasks
+        monitor.reset(timestep);
+        return Status::RUNNING;
+    }
+
+    // detect livelock or deadlock
+    for (auto a : A) {
+        if (a->done) continue;
+        monitor.observe(a->id, pathDist(a->id, a->curr.node), timestep);
+    }
+    monitor.record(config);
+    if (monitor.stalled(timestep)) {
+        auto stalled = monitor.getStalledAgents(timestep);
+        if (recoveries >= max_recoveries) return Status::STALLED;
+        ++recoveries;
+        info(describeStall(stalled) + "; Attempting recovery " + std::to_string(recoveries));
+        recover(A, stalled);
+        monitor.reset(timestep);
+    }
+    return Status::RUNNING;
+}
+
+template <typename Motion>
+std::string PIBT<Motion>::describeStall(const std::vector<int>& stalled) const {
+    std::string kind = (monitor.countDistinct() == 1) ? "Deadlock" : "Livelock";
+    return kind + " detected at timestep " + std::to_string(timestep)
+        + "; " + std::to_string(stalled.size()) + " agents without progress for "
+        + std::to_string(stall_window) + " steps";
+}
+
+template <typename Motion>
+void PIBT<Motion>::run() {
+    info("Running PIBT...");
+
+    initAgents();
+    search();
+}
+
+template <typename Motion>
+void PIBT<Motion>::search() {
+    while (true) {
+        Config config;
+        Status status = update(config);
+        if (status == Status::SOLVED) break;
+        if (status == Status::STALLED) {
+            warn(describeStall(monitor.getStalledAgents(timestep)) + "; Terminating early");
             break;
         }
 
-        if (timestep >= max_timestep) {
+        if (timestep >= max_timestep && isLifelong()) {
+            // lifelong runs end at the horizon
+            solved = true;
+            info("Completed " + std::to_string(tasks_completed) + " tasks in " + std::to_string(timestep)
+                + " steps (throughput " + std::to_string(getThroughput()) + ")");
+            break;
+        } else if (timestep >= max_timestep) {
             warn("Exceeded maximum number of timesteps");
             break;
         } else if (overCompTime()) {
             warn("Exceeded maximum computation time limit");
             break;
+        } else if (stopRequested()) {
+            info("Stopped on request at timestep " + std::to_string(timestep));
+            break;
         }
     }
+}
 
-    // release memory
-    for (auto a : A) {
-        delete a;
+template <typename Motion>
+void PIBT<Motion>::replan() {
+    if (!initialized) {
+        solve();
+        return;
+    }
+    start();
+    applyChanges();
+    precomp_time = getSolverElapsedTime();
+    bool done = true;
+    for (auto& a : pool) done &= a.done;
+    if (done) {
+        solved = true;
+    } else {
+        info("Replanning PIBT from timestep " + std::to_string(timestep) + "...");
+        search();
+    }
+    end();
+}
+
+template <typename Motion>
+void PIBT<Motion>::applyChanges() {
+    // only agents whose start or goal changed since the last solve are touched
+    Config observed(P->getNum());
+    bool moved = false;
+    for (auto& a : pool) {
+        if (P->getStartRevision(a.id) <= revision) continue;
+        State s = P->getStart(a.id);
+        if (a.done) {
+            a.curr = s;     // placed when its goal is reset below
+        } else {
+            observed[a.id] = s;
+            moved = true;
+        }
+    }
+    if (moved) synchronize(observed);
+    for (auto& a : pool) {
+        if (P->getGoalRevision(a.id) > revision || (a.done && P->getStartRevision(a.id) > revision)) {
+            resetGoal(a.id, P->getGoal(a.id));
+        }
+    }
+    revision = P->getRevision();
+}
+
+template <typename Motion>
+void PIBT<Motion>::init() {
+    // like solve, start from an empty plan
+    solution.clear();
+    solved = false;
+    start();
+    if (!distance_shared) createDistanceTable();
+    precomp_time = getSolverElapsedTime();
+    initAgents();
+}
+
+template <typename Motion>
+typename PIBT<Motion>::Status PIBT<Motion>::updateOnline(Config& config) {
+    Status status = update(config);
+    if (status == Status::STALLED) {
+        // an online run cannot terminate; start over with a fresh recovery budget
+        warn(describeStall(monitor.getStalledAgents(timestep)) + "; Resetting recoveries");
+        recoveries = 0;
+        monitor.reset(timestep);
+        status = Status::RUNNING;
+    }
+    return status;
+}
+
+template <typename Motion>
+Config PIBT<Motion>::step() {
+    if (!initialized) error("PIBT is not initialized; Call init() before stepping");
+    auto t_start = Time::now();
+    Config config;
+    updateOnline(config);
+    last_step_time = (int)std::chrono::duration_cast<std::chrono::microseconds>(Time::now() - t_start).count();
+    max_step_time = std::max(max_step_time, last_step_time);
+    if (step_budget > 0 && last_step_time > step_budget) {
+        ++overruns;
+        warn("Step " + std::to_string(timestep) + " took " + std::to_string(last_step_time)
+            + " us, over the budget of " + std::to_string(step_budget) + " us");
+    }
+    return config;
+}
+
+template <typename Motion>
+Config PIBT<Motion>::step(const Config& observed) {
+    if (!initialized) error("PIBT is not initialized; Call init() before stepping");
+    synchronize(observed);
+    return step();
+}
+
+template <typename Motion>
+void PIBT<Motion>::synchronize(const Config& observed) {
+    if ((int)observed.size() != P->getNum()) error("Mismatch between observed states and number of agents");
+    // vacate nodes of agents that deviated from the plan, then occupy observed nodes
+    for (auto& a : pool) {
+        if (a.done || observed[a.id].empty()) continue;
+        if (PackedState(a.curr) == observed[a.id]) continue;
+        if (occupied_now[a.curr.node->id] == &a) occupied_now[a.curr.node->id] = nullptr;
+    }
+    for (auto& a : pool) {
+        if (a.done || observed[a.id].empty()) continue;
+        State s = G->getState(observed[a.id]);
+        auto b = occupied_now[s.node->id];
+        if (b != nullptr && b != &a) {
+            error("Agents " + std::to_string(b->id) + " and " + std::to_string(a.id) + " observed at the same node");
+        }
+        occupied_now[s.node->id] = &a;
+        a.curr = s;
+    }
+}
+
+template <typename Motion>
+void PIBT<Motion>::resetGoal(const int i, const State& goal) {
+    if (!initialized) error("PIBT is not initialized; Call init() before changing goals");
+    if (!(0 <= i && i < (int)pool.size())) error("Invalid agent index; Failed to reset goal");
+    if (goal.node == nullptr) error("Invalid goal state");
+    Agent* a = &pool[i];
+    if (a->done && occupied_now[a->curr.node->id] != nullptr) error("Node of agent " + std::to_string(i) + " is occupied; Failed to reset goal");
+    retarget(a, goal);
+    if (a->done) {
+        // bring back an agent that has already left at its previous goal
+        occupied_now[a->curr.node->id] = a;
+        a->done = false;
+        solved = false;
+    }
+}
+
+template <typename Motion>
+void PIBT<Motion>::retarget(Agent* a, const State& goal) {
+    if (goal.node == nullptr) error("Invalid goal state");
+    if (!Motion::isValidOrientation(goal.orientation)) {
+        // an oriented agent without goal heading would turn at its goal forever
+        error("Goal orientation " + std::to_string(goal.orientation) + " of agent " + std::to_string(a->id)
+            + " is invalid for " + Motion::name + " agents");
     }
+    a->goal = goal;
+    a->idle = false;
+    updateDistance(a->id, goal.node);
+    a->elapsed = 0;
+    a->init_dist = distance_initialized ? pathDist(a->id, a->curr.node) : 0;
+    monitor.retarget(a->id, timestep);
+    resort = true;
 }
+
+template <typename Motion>
+float PIBT<Motion>::getThroughput() const {
+    if (timestep == 0) return 0.f;
+    return 1000.f * tasks_completed / timestep;
+}
+
+template <typename Motion>
+Config PIBT<Motion>::getConfig() const {
+    Config config(P->getNum());
+    for (auto& a : pool) {
+        if (!a.done) config[a.id] = a.curr;
+    }
+    return config;
+}
+
+template <typename Motion>
+void PIBT<Motion>::refreshDistances() {
+    if (!initialized) error("PIBT is not initialized; Call init() before refreshing distances");
+    clearDistanceCache();
+    for (auto& a : pool) updateDistance(a.id, a.goal.node);
+}
+
+template <typename Motion>
+typename PIBT<Motion>::Snapshot PIBT<Motion>::save() const {
+    // agents only; occupied nodes follow from their positions
+    return Snapshot{pool, A, monitor, timestep, recoveries, tasks_completed, solved, resort};
+}
+
+template <typename Motion>
+void PIBT<Motion>::restore(const Snapshot& snapshot) {
+    // same size, so agents stay in place and pointers remain valid;
+    // agents on the map occupy their nodes, so only those entries change
+    for (auto& a : pool) {
+        if (!a.done && occupied_now[a.curr.node->id] == &a) occupied_now[a.curr.node->id] = nullptr;
+    }
+    std::copy(snapshot.pool.begin(), snapshot.pool.end(), pool.begin());
+    for (auto& a : pool) {
+        if (!a.done) occupied_now[a.curr.node->id] = &a;
+    }
+    A = snapshot.A;
+    monitor = snapshot.monitor;
+    timestep = snapshot.timestep;
+    recoveries = snapshot.recoveries;
+    tasks_completed = snapshot.tasks_completed;
+    solved = snapshot.solved;
+    resort = snapshot.resort;
+}
+
+template <typename Motion>
+Plan PIBT<Motion>::planWindow(const int horizon, const int commit) {
+    if (!initialized) error("PIBT is not initialized; Call init() before planning");
+    if (!(0 < commit && commit <= horizon)) error("Committed steps must be within the horizon");
+    Plan window(G);
+    window.add(getConfig());
+    std::unique_ptr<Snapshot> committed;
+    for (int h = 1; h <= horizon; ++h) {
+        Config config;
+        Status status = updateOnline(config);
+        window.add(config);
+        if (h == commit && h < horizon) {
+            committed = std::make_unique<Snapshot>(save());
+            lookahead = true;
+        }
+        if (status == Status::SOLVED) break;
+    }
+    lookahead = false;
+    if (committed != nullptr) restore(*committed);
+    return window;
+}
+
+template class PIBT<Omnidirectional>;
+template class PIBT<Oriented>;
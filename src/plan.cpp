@@ -1,149 +1,405 @@
 #include "plan.h"
+#include "planio.h"
 
 
-Config Plan::get(const int t) const {
-    if (configs.empty()) error("Plan is empty; Failed to retrieve agent configurations");
-    if (!(0 <= t && t < (int)configs.size())) error("Invalid timestep; Failed to retrieve agent configurations");
-    return configs[t];
+std::ostream& operator<<(std::ostream& os, const Conflict& c) {
+    switch (c.type) {
+        case ConflictType::START : os << "Incorrect start state of agent " << c.i; break;
+        case ConflictType::GOAL : os << "Agent " << c.i << " did not reach its goal"; break;
+        case ConflictType::TRANSITION : os << c.reason << "; agent " << c.i << " at timestep " << c.t; break;
+        case ConflictType::VERTEX : os << "Vertex conflict between agents " << c.i << " and " << c.j << " at timestep " << c.t; break;
+        case ConflictType::EDGE : os << "Edge conflict between agents " << c.i << " and " << c.j << " at timestep " << c.t; break;
+    }
+    return os;
 }
 
-State Plan::get(const int t, const int i) const {
-    if (configs.empty()) error("Plan is empty; Failed to retrieve agent state");
-    if (!(0 <= t && t < (int)configs.size())) error("Invalid timestep; Failed to retrieve agent state");
-    if (!(0 <= i && i < (int)configs.at(0).size())) error("Invalid agent index; Failed to retrieve agent state");
-    return configs[t][i];
+Plan::Reader::Reader(const Plan* plan, int i, int t) : plan(plan), track(&plan->tracks[i]) {
+    // start from the closest checkpoint, then replay symbols
+    int s = std::min(t, track->symbols);
+    int c = s / Track::CHECKPOINT;
+    std::tie(state, jump) = track->checkpoints[c];
+    k = c * Track::CHECKPOINT;
+    while (k < s) next();
 }
 
-Config Plan::getLast() const {
-    // get final state of all agents
-    if (configs.empty()) error("Plan is empty; Failed to retrieve final configuration");
-    const int N = (int)configs.at(0).size();
+void Plan::Reader::next() {
+    // state is kept after the last stored symbol (trailing waits)
+    if (k >= track->symbols) return;
+    state = plan->decode(state, track->symbol(k), *track, jump);
+    ++k;
+}
+
+uint8_t Plan::encode(const PackedState& p, const PackedState& q) const {
+    if (p == q) return WAIT;
+    if (p.empty() || q.empty() || width == 0) return JUMP;
+    int h = p.orientation();
+    if (p.id() == q.id()) {
+        if (h == -1 || q.orientation() == -1) return JUMP;
+        if (q.orientation() == Heading::LEFT[h]) return TURN_LEFT;
+        if (q.orientation() == Heading::RIGHT[h]) return TURN_RIGHT;
+        return JUMP;
+    }
+    if (q.orientation() != h) return JUMP;
+    int d = Heading::of(q.id() % width - p.id() % width, q.id() / width - p.id() / width);
+    if (d == -1) return JUMP;
+    return MOVE + d;
+}
+
+PackedState Plan::decode(const PackedState& p, uint8_t symbol, const Track& track, int& jump) const {
+    switch (symbol) {
+        case WAIT : return p;
+        case TURN_LEFT : return PackedState::fromCode(PackedState::pack(p.id(), Heading::LEFT[p.orientation()]));
+        case TURN_RIGHT : return PackedState::fromCode(PackedState::pack(p.id(), Heading::RIGHT[p.orientation()]));
+        case JUMP : return track.jumps[jump++];
+        default : break;
+    }
+    int d = symbol - MOVE;
+    int id = p.id() + Heading::DX[d] + Heading::DY[d] * width;
+    return PackedState::fromCode(PackedState::pack(id, p.orientation()));
+}
+
+void Plan::push(Track& track, uint8_t symbol) {
+    int k = track.symbols++;
+    if (k % Track::PER_WORD == 0) track.words.push_back(0);
+    track.words.back() |= (uint64_t)symbol << (3 * (k % Track::PER_WORD));
+}
+
+void Plan::append(Track& track, const PackedState& q, int t) {
+    if (q == track.last) {
+        ++track.pending;
+        return;
+    }
+    for (; track.pending > 0; --track.pending) {
+        push(track, WAIT);
+        if (track.symbols % Track::CHECKPOINT == 0) track.checkpoints.emplace_back(track.last, (int)track.jumps.size());
+    }
+    uint8_t symbol = encode(track.last, q);
+    if (symbol == JUMP) track.jumps.push_back(q);
+    push(track, symbol);
+    if (track.symbols % Track::CHECKPOINT == 0) track.checkpoints.emplace_back(q, (int)track.jumps.size());
+    track.last = q;
+    if (q.empty()) {
+        track.end = t;
+        track.departures.emplace_back(t, track.tail);
+    } else {
+        track.end = -1;
+        track.tail = q;
+    }
+}
+
+PackedState Plan::departure(const int i, const int t) const {
+    // state agent i left in most recently before timestep t
+    const auto& departures = tracks[i].departures;
+    auto itr = std::upper_bound(departures.begin(), departures.end(), t - 1,
+        [](int v, const std::pair<int, PackedState>& d) {return v < d.first;});
+    return (itr == departures.begin()) ? PackedState() : std::prev(itr)->second;
+}
+
+Config Plan::get(const int t) const {
+    if (length == 0) error("Plan is empty; Failed to retrieve agent configurations");
+    if (!(0 <= t && t < length)) error("Invalid timestep; Failed to retrieve agent configurations");
     Config config;
-    for (int i = 0; i < N; ++i) {
-        Path path = getPath(i);
-        config.push_back(path.back());
+    for (int i = 0; i < size(); ++i) {
+        config.push_back(Reader(this, i, t).get());
     }
     return config;
 }
 
-bool Plan::sameConfig(const Config& a, const Config& b) const {
-    if (a.size() != b.size()) return false;
-    for (int i = 0; i < (int)a.size(); ++i) {
-        if (a[i] != b[i]) return false;
+PackedState Plan::get(const int t, const int i) const {
+    if (length == 0) error("Plan is empty; Failed to retrieve agent state");
+    if (!(0 <= t && t < length)) error("Invalid timestep; Failed to retrieve agent state");
+    if (!(0 <= i && i < size())) error("Invalid agent index; Failed to retrieve agent state");
+    return Reader(this, i, t).get();
+}
+
+Config Plan::getLast() const {
+    // get final state of all agents
+    if (length == 0) error("Plan is empty; Failed to retrieve final configuration");
+    Config config;
+    for (auto& track : tracks) {
+        config.push_back(track.tail);
     }
-    return true;
+    return config;
 }
 
-bool Plan::validate(const Config& start, const Config& goal) const {
-    if (configs.empty()) error("Plan is empty; Nothing to validate");
-    // check goal configuration
-    if (!sameConfig(getLast(), goal)) {
-        warn("Validation failed; Agents did not reach their goal");
-        return false;
+template <typename Motion>
+void Plan::findConflicts(const Grid* G, int t_begin, int t_end, Conflicts& conflicts) const {
+    // check timesteps [t_begin, t_end) against their predecessors, replaying
+    // all agents side by side; node occupancy is stamped with the timestep
+    const int N = size();
+    std::vector<Reader> R;
+    Config config_prev(N), config_curr(N);
+    for (int i = 0; i < N; ++i) {
+        R.push_back(Reader(this, i, t_begin - 1));
+        config_prev[i] = R[i].get();
     }
-    // check start configuration
-    if (!sameConfig(get(0), start)) {
-        warn("Validation failed; Incorrect agent start states");
-        return false;
+    std::vector<int> agent_prev(G->size(), -1), agent_curr(G->size(), -1);
+    std::vector<int> stamp_prev(G->size(), -1), stamp_curr(G->size(), -1);
+    for (int i = 0; i < N; ++i) {
+        if (config_prev[i].empty()) continue;
+        agent_prev[config_prev[i].id()] = i;
+        stamp_prev[config_prev[i].id()] = t_begin - 1;
     }
-    // check conflicts
-    const int N = (int)get(0).size();
-    for (int t = 1; t <= getMakespan(); ++t) {
-        if ((int)get(t).size() != N) {
-            warn("Validation failed; Unknown size of configuration");
-            return false;
+
+    for (int t = t_begin; t < t_end; ++t) {
+        for (int i = 0; i < N; ++i) {
+            R[i].next();
+            config_curr[i] = R[i].get();
         }
 
+        // transitions and vertex conflicts
         for (int i = 0; i < N; ++i) {
-            State curr = get(t, i);
-            if (curr.node == nullptr) continue;     // agent does not exist on this timestep
-            State prev = get(t - 1, i);
-            Nodes V = prev.node->neighbor;
-            V.push_back(curr.node);
-            if (!inArray(curr.node, V)) {
-                warn("Validation failed; Agent made an invalid transition");
-                return false;
+            PackedState curr = config_curr[i];
+            if (curr.empty()) continue;     // agent does not exist on this timestep
+            PackedState prev = config_prev[i];
+            if (prev.empty()) prev = departure(i, t);       // agents return from where they left
+            if (prev.empty()) {
+                conflicts.push_back({ConflictType::TRANSITION, t, i, -1, "Agent reappeared after leaving"});
+            } else {
+                const char* reason = Motion::checkTransition(G->getState(prev), G->getState(curr));
+                if (reason != nullptr) conflicts.push_back({ConflictType::TRANSITION, t, i, -1, reason});
             }
-            if (prev.node == curr.node) {
-                int dtheta = (curr.orientation - prev.orientation + 4) % 4;
-                if (!(dtheta == 0 || dtheta == 1 || dtheta == 3)) {
-                    warn("Validation failed; Agent made an invalid rotation");
-                    return false;
-                }
+            int v = curr.id();
+            if (stamp_curr[v] == t) {
+                conflicts.push_back({ConflictType::VERTEX, t, agent_curr[v], i, nullptr});
             } else {
-                if (prev.orientation != curr.orientation) {
-                    warn("Validation failed; Agent made an invalid move with rotation");
-                    return false;
-                }
-                Pos ds;
-                switch (prev.orientation) {
-                    case 0 : ds = Pos(0, 1); break;
-                    case 1 : ds = Pos(-1, 0); break;
-                    case 2 : ds = Pos(0, -1); break;
-                    case 3 : ds = Pos(1, 0); break;
-                    default : error("Unknown agent orientation");
-                }
-                if (!(prev.node->pos + ds == curr.node->pos)) {
-                    warn("Validation failed; Agent made an invalid move");
-                    return false;
-                }
+                stamp_curr[v] = t;
+                agent_curr[v] = i;
             }
+        }
 
-            for (int j = i + 1; j < N; ++j) {
-                State other_curr = get(t, j);
-                State other_prev = get(t - 1, j);
-                if (curr.node == other_curr.node) {
-                    warn("Validation failed; Vertex conflict");
-                    return false;
-                }
-                if (curr.node == other_prev.node && prev.node == other_curr.node) {
-                    warn("Validation failed; Edge conflict");
-                    return false;
-                }
+        // edge conflicts, agents swapping nodes
+        for (int i = 0; i < N; ++i) {
+            PackedState curr = config_curr[i];
+            PackedState prev = config_prev[i];
+            if (curr.empty() || prev.empty() || curr.id() == prev.id()) continue;
+            int v = curr.id();
+            if (stamp_prev[v] != t - 1) continue;
+            int j = agent_prev[v];
+            if (j <= i) continue;       // report each pair once
+            if (!config_curr[j].empty() && config_curr[j].id() == prev.id()) {
+                conflicts.push_back({ConflictType::EDGE, t, i, j, nullptr});
             }
         }
+        std::swap(config_prev, config_curr);
+        std::swap(agent_prev, agent_curr);
+        std::swap(stamp_prev, stamp_curr);
     }
-    return true;
+}
+
+int Plan::getSOC() const {
+    int soc = 0;
+    for (int i = 0; i < size(); ++i) soc += std::max(0, getPathLength(i) - 1);
+    return soc;
+}
+
+size_t Plan::getMemoryUsage() const {
+    size_t bytes = sizeof(Plan) + tracks.capacity() * sizeof(Track);
+    for (auto& track : tracks) {
+        bytes += track.words.capacity() * sizeof(uint64_t);
+        bytes += track.jumps.capacity() * sizeof(PackedState);
+        bytes += track.checkpoints.capacity() * sizeof(std::pair<PackedState, int>);
+        bytes += track.departures.capacity() * sizeof(std::pair<int, PackedState>);
+    }
+    return bytes;
 }
 
 void Plan::save(const std::string& filename) const {
-    if (configs.empty()) {
+    if (length == 0) {
         warn("Plan is empty; Nothing to save");
         return;
     }
 
+    if (G == nullptr) error("Plan is not bound to a graph; Failed to save");
     std::ofstream myfile;
     myfile.open(filename, std::ios::out | std::ios::trunc);
     for (int i = 0; i < size(); ++i) {
         Path path = getPath(i);
         myfile << "[Agent " << std::right << std::setw(3) << i << "] : ";
         for (auto state : path) {
-            myfile << state << " ";
+            if (state.empty()) myfile << "(  -,  -,  -) ";     // agent absent
+            else myfile << G->getState(state) << " ";
         }
-        myfile << std::endl;
+        myfile << "\n";
     }
     myfile.close();
 }
 
+void Plan::saveBinary(const std::string& filename, int block_size) const {
+    if (length == 0) {
+        warn("Plan is empty; Nothing to save");
+        return;
+    }
+
+    PlanWriter out(filename, G, size(), block_size);
+    std::vector<Reader> readers;
+    for (int i = 0; i < size(); ++i) readers.push_back(getReader(i));
+    Config config(size());
+    for (int t = 0; t < length; ++t) {
+        for (int i = 0; i < size(); ++i) {
+            if (t > 0) readers[i].next();
+            config[i] = readers[i].get();
+        }
+        out.push(config);
+    }
+    out.close();
+}
+
+void Plan::stream(const std::string& filename, int block_size) {
+    if (length != 0) error("Plan is not empty; Streaming must start with the first config");
+    stream_file = filename;
+    stream_block_size = block_size;
+}
+
+void Plan::closeStream() {
+    // the stream ends even if closing fails, the error reaches the caller
+    std::shared_ptr<PlanWriter> closing = std::move(writer);
+    writer.reset();
+    stream_file.clear();
+    if (closing != nullptr) closing->close();
+}
+
+void Plan::assign(const Plan& other) {
+    clear();
+    if (stream_file.empty()) {
+        tracks = other.tracks;
+        length = other.length;
+        return;
+    }
+    // configs go through add so that the stream receives them
+    std::vector<Reader> readers;
+    for (int i = 0; i < other.size(); ++i) readers.push_back(other.getReader(i));
+    Config config(other.size());
+    for (int t = 0; t < other.length; ++t) {
+        for (int i = 0; i < other.size(); ++i) {
+            if (t > 0) readers[i].next();
+            config[i] = readers[i].get();
+        }
+        add(config);
+    }
+}
+
 void Plan::add(const Config& c) {
-    if (!configs.empty() && configs.at(0).size() != c.size()) {
+    if (!stream_file.empty()) {
+        try {
+            if (writer == nullptr) writer = std::make_shared<PlanWriter>(stream_file, G, (int)c.size(), stream_block_size);
+            writer->push(c);
+        } catch (const MAPFError&) {
+            writer.reset();
+            stream_file.clear();
+            throw;
+        }
+    }
+    if (length == 0) {
+        tracks.assign(c.size(), Track());
+        for (int i = 0; i < (int)c.size(); ++i) {
+            Track& track = tracks[i];
+            track.checkpoints.emplace_back(c[i], 0);
+            track.last = c[i];
+            track.tail = c[i];
+            if (c[i].empty()) track.end = 0;
+        }
+        ++length;
+        return;
+    }
+    if ((int)c.size() != size()) {
         error("Failed to add config to plan; Mismatch in size");
     }
-    configs.push_back(c);
+    for (int i = 0; i < size(); ++i) {
+        append(tracks[i], c[i], length);
+    }
+    ++length;
+}
+
+Plan::Reader Plan::getReader(const int i, const int t) const {
+    if (length == 0) error("Plan is empty; Failed to read agent states");
+    if (!(0 <= i && i < size())) error("Invalid agent index; Failed to read agent states");
+    return Reader(this, i, t);
 }
 
 Path Plan::getPath(const int i) const {
-    if (configs.empty()) error("Plan is empty; Failed to retrieve agent path");
-    if (!(0 <= i && i < (int)configs.at(0).size())) error("Invalid agent index; Failed to retrieve agent path");
+    if (length == 0) error("Plan is empty; Failed to retrieve agent path");
+    if (!(0 <= i && i < size())) error("Invalid agent index; Failed to retrieve agent path");
     Path path;
-    for (int t = 0; t <= getMakespan(); ++t) {
-        State state = get(t, i);
-        if (state.node == nullptr) break;
-        path.push_back(state);
-    }
+    Reader reader(this, i, 0);
+    int stop = getPathLength(i);
+    for (int t = 0; t < stop; ++t, reader.next()) path.push_back(reader.get());
     return path;
 }
 
-bool Plan::validate(MAPF_Instance* P) const {
-    return validate(P->getConfigStart(), P->getConfigGoal());
+int Plan::getPathLength(const int i) const {
+    if (!(0 <= i && i < size())) error("Invalid agent index; Failed to retrieve path length");
+    const Track& track = tracks[i];
+    return (track.end == -1) ? length : track.end;
+}
+
+void Plan::exportStates(int32_t* out) const {
+    // time-major, decoding every track once
+    std::vector<Reader> readers;
+    for (int i = 0; i < size(); ++i) readers.push_back(getReader(i));
+    for (int t = 0; t < length; ++t) {
+        for (int i = 0; i < size(); ++i, out += 3) {
+            if (t > 0) readers[i].next();
+            PackedState state = readers[i].get();
+            if (state.empty()) {
+                out[0] = out[1] = out[2] = -1;
+            } else {
+                out[0] = state.id() % width;
+                out[1] = state.id() / width;
+                out[2] = state.orientation();
+            }
+        }
+    }
+}
+
+Conflicts Plan::findConflicts(MAPF_Instance* P, int num_threads) const {
+    if (length == 0) error("Plan is empty; Nothing to validate");
+    const Config& config_s = P->getConfigStart();
+    const Config& config_g = P->getConfigGoal();
+    if ((int)config_s.size() != size()) error("Mismatch between plan and number of agents");
+    Conflicts conflicts;
+    // check start and goal configurations
+    Config start = get(0), last = getLast();
+    for (int i = 0; i < size(); ++i) {
+        if (start[i] != config_s[i]) conflicts.push_back({ConflictType::START, 0, i, -1, nullptr});
+        if (last[i] != config_g[i]) conflicts.push_back({ConflictType::GOAL, getMakespan(), i, -1, nullptr});
+    }
+
+    // resolved before any thread starts, the workers themselves never raise
+    void (Plan::*check)(const Grid*, int, int, Conflicts&) const = nullptr;
+    switch (P->getMotionModel()) {
+        case MotionModel::OMNIDIRECTIONAL : check = &Plan::findConflicts<Omnidirectional>; break;
+        case MotionModel::ORIENTED : check = &Plan::findConflicts<Oriented>; break;
+        default : error("Agents with and without heading cannot be mixed");
+    }
+
+    // check transitions and conflicts, timesteps split across threads
+    if (num_threads <= 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::max(1, std::min(num_threads, getMakespan() / 64));
+    const int chunk = (getMakespan() + num_threads - 1) / num_threads;
+    std::vector<Conflicts> found(num_threads);
+    std::vector<std::thread> workers;
+    for (int k = 1; k < num_threads; ++k) {
+        int t_begin = 1 + k * chunk;
+        int t_end = std::min(length, 1 + (k + 1) * chunk);
+        workers.emplace_back(check, this, P->getG(), t_begin, t_end, std::ref(found[k]));
+    }
+    (this->*check)(P->getG(), 1, std::min(length, 1 + chunk), found[0]);
+    for (auto& w : workers) w.join();
+    for (auto& c : found) conflicts.insert(conflicts.end(), c.begin(), c.end());
+    return conflicts;
+}
+
+bool Plan::validate(MAPF_Instance* P, int num_threads) const {
+    if (P->getMotionModel() == MotionModel::MIXED) {
+        warn("Validation failed; Agents with and without heading cannot be mixed");
+        return false;
+    }
+    Conflicts conflicts = findConflicts(P, num_threads);
+    for (auto& c : conflicts) {
+        std::stringstream ss;
+        ss << c;
+        warn("Validation failed; " + ss.str());
+    }
+    return conflicts.empty();
 }
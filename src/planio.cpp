@@ -0,0 +1,302 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+
+#include "planio.h"
+
+
+namespace {
+    // fixed-width fields are little-endian whatever the host byte order
+    template <typename T>
+    void put(std::vector<uint8_t>& out, T value) {
+        static_assert(std::is_unsigned_v<T>, "Fields are unsigned integers");
+        for (size_t k = 0; k < sizeof(T); ++k) out.push_back((uint8_t)(value >> (8 * k)));
+    }
+
+    template <typename T>
+    T take(const uint8_t* p) {
+        static_assert(std::is_unsigned_v<T>, "Fields are unsigned integers");
+        T value = 0;
+        for (size_t k = 0; k < sizeof(T); ++k) value |= (T)p[k] << (8 * k);
+        return value;
+    }
+
+    void putVarint(std::vector<uint8_t>& out, uint64_t x) {
+        while (x >= 0x80) {
+            out.push_back((uint8_t)(x | 0x80));
+            x >>= 7;
+        }
+        out.push_back((uint8_t)x);
+    }
+
+    // false if the varint runs past end
+    bool takeVarint(const uint8_t*& p, const uint8_t* end, uint64_t& x) {
+        x = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p == end) return false;
+            uint8_t byte = *p++;
+            x |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    uint64_t zigzag(int64_t x) {return ((uint64_t)x << 1) ^ (uint64_t)(x >> 63);}
+    int64_t unzigzag(uint64_t x) {return (int64_t)(x >> 1) ^ -(int64_t)(x & 1);}
+}
+
+PlanWriter::PlanWriter(const std::string& filename, const Grid* G, int num_agents, int block_size) :
+    filename(filename),
+    num_agents(num_agents),
+    block_size(block_size),
+    length(0),
+    steps(0),
+    prev(num_agents, PackedState::NONE),
+    run(num_agents, 0),
+    buf(num_agents),
+    closed(false) {
+        if (G == nullptr) error("Plan is not bound to a graph; Failed to write plan");
+        if (block_size <= 0) error("Block size must be positive");
+        file.open(filename, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!file) error("File " + filename + " cannot be opened");
+
+        std::vector<uint8_t> header(PLAN_MAGIC, PLAN_MAGIC + 8);
+        put<uint32_t>(header, PLAN_VERSION);
+        put<uint32_t>(header, num_agents);
+        put<uint32_t>(header, G->getWidth());
+        put<uint32_t>(header, G->getHeight());
+        put<uint64_t>(header, G->getHash());
+        put<uint32_t>(header, block_size);
+        put<uint32_t>(header, 0);
+        file.write(reinterpret_cast<const char*>(header.data()), header.size());
+        check();
+    }
+
+PlanWriter::~PlanWriter() {
+    // errors are raised by an explicit close; a destructor must not throw
+    try {
+        close();
+    } catch (const MAPFError&) {}
+}
+
+void PlanWriter::check() {
+    if (file) return;
+    closed = true;      // nothing more is written
+    error("Failed to write " + filename + "; The plan file is incomplete");
+}
+
+void PlanWriter::push(const Config& c) {
+    if (closed) error("Plan writer is closed");
+    if ((int)c.size() != num_agents) error("Failed to write config; Mismatch in size");
+    for (int i = 0; i < num_agents; ++i) {
+        uint32_t code = c[i].code;
+        if (steps == 0) {
+            // every block starts from absolute states
+            putVarint(buf[i], (code == PackedState::NONE) ? 0 : (uint64_t)code + 1);
+        } else if (code == prev[i]) {
+            ++run[i];
+        } else {
+            if (run[i] > 0) putVarint(buf[i], (run[i] << 1) | 1);
+            run[i] = 0;
+            putVarint(buf[i], zigzag((int64_t)code - (int64_t)prev[i]) << 1);
+        }
+        prev[i] = code;
+    }
+    ++length;
+    if (++steps == block_size) flush();
+}
+
+void PlanWriter::flush() {
+    if (steps == 0) return;
+    std::vector<uint8_t> block;
+    put<uint32_t>(block, length - steps);
+    put<uint32_t>(block, steps);
+    uint64_t offset = 0;
+    for (int i = 0; i < num_agents; ++i) {
+        if (run[i] > 0) putVarint(buf[i], (run[i] << 1) | 1);
+        run[i] = 0;
+        put<uint64_t>(block, offset);
+        offset += buf[i].size();
+    }
+    put<uint64_t>(block, offset);
+
+    blocks.push_back((uint64_t)file.tellp());
+    file.write(reinterpret_cast<const char*>(block.data()), block.size());
+    for (auto& b : buf) {
+        file.write(reinterpret_cast<const char*>(b.data()), b.size());
+        b.clear();
+    }
+    steps = 0;
+    check();
+}
+
+void PlanWriter::close() {
+    if (closed) return;
+    flush();
+    std::vector<uint8_t> footer;
+    for (auto offset : blocks) put<uint64_t>(footer, offset);
+    put<uint64_t>(footer, blocks.size());
+    put<uint64_t>(footer, length);
+    footer.insert(footer.end(), PLAN_MAGIC_END, PLAN_MAGIC_END + 8);
+    file.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+    file.close();
+    check();
+    closed = true;
+}
+
+bool PlanReader::Cursor::next() {
+    if (run > 0) {
+        --run;
+        return true;
+    }
+    uint64_t token;
+    if (!takeVarint(p, end, token)) return false;
+    if (token & 1) {
+        if ((token >> 1) == 0) return false;
+        run = (token >> 1) - 1;
+    } else {
+        code = (uint32_t)((int64_t)code + unzigzag(token >> 1));
+    }
+    return true;
+}
+
+PlanReader::PlanReader(const std::string& filename) : fd(-1), data(nullptr), bytes(0) {
+    // the destructor does not run for a failed constructor
+    try {
+        load(filename);
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+PlanReader::~PlanReader() {
+    release();
+}
+
+void PlanReader::release() {
+    if (data != nullptr) munmap(const_cast<uint8_t*>(data), bytes);
+    if (fd >= 0) ::close(fd);
+    data = nullptr;
+    fd = -1;
+}
+
+void PlanReader::load(const std::string& filename) {
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) error("File " + filename + " is not found");
+    struct stat st;
+    if (fstat(fd, &st) != 0) error("Failed to read " + filename);
+    bytes = st.st_size;
+    if (bytes < PLAN_HEADER_SIZE + PLAN_FOOTER_SIZE) error("File " + filename + " is not a binary plan");
+    void* addr = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) error("Failed to map " + filename);
+    data = static_cast<const uint8_t*>(addr);
+
+    if (std::memcmp(data, PLAN_MAGIC, 8) != 0) error("File " + filename + " is not a binary plan");
+    if (take<uint32_t>(data + 8) != PLAN_VERSION) error("Unsupported binary plan version");
+    const uint32_t agents = take<uint32_t>(data + 12);
+    const uint32_t w = take<uint32_t>(data + 16);
+    const uint32_t h = take<uint32_t>(data + 20);
+    map_hash = take<uint64_t>(data + 24);
+    const uint32_t block = take<uint32_t>(data + 32);
+    if (agents > INT_MAX || w > INT_MAX || h > INT_MAX) error("Binary plan " + filename + " is corrupted");
+    if (block == 0 || block > INT_MAX) error("Binary plan " + filename + " has an invalid block size");
+    num_agents = (int)agents;
+    width = (int)w;
+    height = (int)h;
+    block_size = (int)block;
+
+    // everything read later is checked against the file size here
+    const size_t footer = bytes - PLAN_FOOTER_SIZE;
+    if (std::memcmp(data + footer + 16, PLAN_MAGIC_END, 8) != 0) error("Binary plan " + filename + " is incomplete");
+    const uint64_t num_blocks = take<uint64_t>(data + footer);
+    const uint64_t steps_total = take<uint64_t>(data + footer + 8);
+    if (num_blocks > (footer - PLAN_HEADER_SIZE) / 8) error("Binary plan " + filename + " is corrupted");
+    if (steps_total > INT_MAX) error("Binary plan " + filename + " is corrupted");
+    length = (int)steps_total;
+    if (num_blocks != (steps_total + block_size - 1) / block_size) error("Binary plan " + filename + " is corrupted");
+    const size_t index = footer - 8 * num_blocks;
+    const uint64_t table = 8 + 8 * ((uint64_t)num_agents + 1);    // block header and stream offsets
+    uint64_t begin = PLAN_HEADER_SIZE;      // blocks follow each other
+    for (uint64_t b = 0; b < num_blocks; ++b) {
+        const uint64_t offset = take<uint64_t>(data + index + 8 * b);
+        if (offset < begin || offset > index || index - offset < table) error("Binary plan " + filename + " is corrupted");
+        const uint64_t first = take<uint32_t>(data + offset);
+        const uint64_t steps = take<uint32_t>(data + offset + 4);
+        if (first != b * block_size || steps != std::min<uint64_t>(block_size, steps_total - first)) {
+            error("Binary plan " + filename + " is corrupted");
+        }
+        uint64_t last = 0;
+        for (int i = 0; i <= num_agents; ++i) {
+            const uint64_t o = take<uint64_t>(data + offset + 8 + 8 * i);
+            if (o < last) error("Binary plan " + filename + " is corrupted");
+            last = o;
+        }
+        if (last > index - offset - table) error("Binary plan " + filename + " is corrupted");
+        blocks.push_back(offset);
+        begin = offset + table + last;
+    }
+}
+
+PlanReader::Cursor PlanReader::cursor(int b, int i) const {
+    // position at the first timestep of block b
+    const uint8_t* block = data + blocks[b];
+    const uint8_t* streams = block + 8 + 8 * (num_agents + 1);
+    Cursor c{streams + take<uint64_t>(block + 8 + 8 * i), streams + take<uint64_t>(block + 16 + 8 * i), 0, 0};
+    uint64_t first;
+    if (!takeVarint(c.p, c.end, first)) error("Binary plan is corrupted");
+    c.code = (first == 0) ? PackedState::NONE : (uint32_t)(first - 1);
+    return c;
+}
+
+void PlanReader::advance(Cursor& c) const {
+    if (!c.next()) error("Binary plan is corrupted");
+}
+
+PackedState PlanReader::get(const int t, const int i) const {
+    if (!(0 <= t && t < length)) error("Invalid timestep; Failed to retrieve agent state");
+    if (!(0 <= i && i < num_agents)) error("Invalid agent index; Failed to retrieve agent state");
+    Cursor c = cursor(t / block_size, i);
+    for (int k = 0; k < t % block_size; ++k) advance(c);
+    return PackedState::fromCode(c.code);
+}
+
+Path PlanReader::getPath(const int i) const {
+    if (!(0 <= i && i < num_agents)) error("Invalid agent index; Failed to retrieve agent path");
+    Path path;
+    for (int b = 0; b < (int)blocks.size(); ++b) {
+        Cursor c = cursor(b, i);
+        int steps = std::min(block_size, length - b * block_size);
+        for (int k = 0; k < steps; ++k) {
+            if (k > 0) advance(c);
+            path.push_back(PackedState::fromCode(c.code));
+        }
+    }
+    while (!path.empty() && path.back().empty()) path.pop_back();     // trailing absence
+    return path;
+}
+
+void PlanReader::checkMap(const Grid* G) const {
+    if (G->getHash() != map_hash) error("Binary plan was made for a different map");
+}
+
+Plan PlanReader::toPlan(const Grid* G) const {
+    checkMap(G);
+    Plan plan(G);
+    Config config(num_agents);
+    std::vector<Cursor> C(num_agents);
+    for (int b = 0; b < (int)blocks.size(); ++b) {
+        for (int i = 0; i < num_agents; ++i) C[i] = cursor(b, i);
+        int steps = std::min(block_size, length - b * block_size);
+        for (int k = 0; k < steps; ++k) {
+            for (int i = 0; i < num_agents; ++i) {
+                if (k > 0) advance(C[i]);
+                config[i] = PackedState::fromCode(C[i].code);
+            }
+            plan.add(config);
+        }
+    }
+    return plan;
+}
@@ -0,0 +1,83 @@
+#include "portfolio.h"
+
+
+Portfolio::Portfolio(MAPF_Instance* P, std::vector<std::unique_ptr<MAPF_Solver>> members, Mode mode) :
+    MAPF_Solver(P),
+    members(std::move(members)),
+    mode(mode),
+    winner(-1) {
+        solver_name = "Portfolio";
+        if (this->members.empty()) error("Portfolio without solvers");
+        for (auto& member : this->members) {
+            if (member->getP() != P) error("Portfolio members must solve the same instance");
+        }
+    }
+
+Portfolio::Mode Portfolio::parseMode(const std::string& name) {
+    if (name == "first") return Mode::FIRST;
+    if (name == "soc") return Mode::BEST_SOC;
+    if (name == "makespan") return Mode::BEST_MAKESPAN;
+    throw MAPFError("Unknown portfolio mode " + name);
+}
+
+void Portfolio::run() {
+    info("Running " + std::to_string(members.size()) + " solvers...");
+    for (auto& member : members) member->shareDistanceTable(distance_table);
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    int finished = 0;
+    std::vector<bool> done(members.size(), false);     // finished members have already cleared their stop flag
+    auto stopRunning = [&]() {
+        for (size_t k = 0; k < members.size(); ++k) {
+            if (!done[k]) members[k]->requestStop();
+        }
+    };
+    winner = -1;
+    auto cost = [&](int k) {
+        const Plan& plan = members[k]->getSolution();
+        if (mode == Mode::BEST_MAKESPAN) return std::make_pair(plan.getMakespan(), plan.getSOC());
+        return std::make_pair(plan.getSOC(), plan.getMakespan());
+    };
+    auto worker = [&](int k) {
+        bool valid = false;
+        try {
+            members[k]->solve();
+            valid = members[k]->succeed() && members[k]->getSolution().findConflicts(P, 1).empty();
+        } catch (const std::exception& e) {
+            warn("Member " + std::to_string(k) + " failed; " + e.what());
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        done[k] = true;
+        if (valid && winner == -1) {
+            winner = k;
+            if (mode == Mode::FIRST) stopRunning();
+        } else if (valid && mode != Mode::FIRST && cost(k) < cost(winner)) {
+            winner = k;
+        }
+        ++finished;
+        cv.notify_all();
+    };
+
+    std::vector<std::thread> threads;
+    for (int k = 0; k < (int)members.size(); ++k) threads.emplace_back(worker, k);
+    {
+        // members stop on their own limits; the deadline covers the portfolio as a whole
+        std::unique_lock<std::mutex> lock(mtx);
+        auto deadline = Time::now() + std::chrono::milliseconds(getRemainedTime());
+        if (!cv.wait_until(lock, deadline, [&] {return finished == (int)members.size();})) stopRunning();
+    }
+    for (auto& thread : threads) thread.join();
+    // a member may end its solve just before it is marked done; nothing runs any more
+    for (auto& member : members) member->clearStop();
+
+    if (winner == -1) {
+        warn("No member found a valid plan");
+        solution.assign(members[0]->getSolution());
+        return;
+    }
+    solution.assign(members[winner]->getSolution());
+    solved = true;
+    info("Solution of member " + std::to_string(winner) + " (seed " + std::to_string(members[winner]->getSeed())
+        + ", makespan " + std::to_string(solution.getMakespan()) + ", soc " + std::to_string(solution.getSOC()) + ")");
+}
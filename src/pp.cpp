@@ -0,0 +1,97 @@
+#include "pp.h"
+
+
+template <typename Motion>
+bool PrioritizedPlanning<Motion>::plan(int& failed) {
+    table.clear();
+    paths.assign(P->getNum(), Path());
+    SpaceTimeAStar<Motion> search(G, table);
+    auto interrupted = [&]() {return overCompTime() || stopRequested();};
+    auto findPath = [&](const int i) {
+        bool found = search.findPath(P->getConfigStart()[i], P->getConfigGoal()[i],
+            [&](Node* v) {return steps[i][v->id];}, max_timestep, paths[i], interrupted);
+        num_expanded += search.getNumExpanded();
+        return found;
+    };
+
+    // agents not planned yet hold their starts for a while, so that paths of
+    // others do not run over them before they move; agents without a path
+    // are deferred, and once every remaining agent was deferred the next one
+    // ignores the held starts
+    table.setHoldWindow(hold_window);
+    for (auto i : order) table.hold(i, G->getNode(P->getConfigStart()[i].id()));
+    std::deque<int> queue(order.begin(), order.end());
+    for (int deferred = 0; !queue.empty(); ) {
+        const int i = queue.front();
+        queue.pop_front();
+        Node* const s = G->getNode(P->getConfigStart()[i].id());
+        table.unhold(s);
+        bool found = false;
+        if (deferred > (int)queue.size()) {
+            table.setHoldWindow(-1);
+            found = findPath(i);
+            table.setHoldWindow(hold_window);
+        } else {
+            found = findPath(i);
+            if (!found && !interrupted()) {
+                table.hold(i, s);
+                queue.push_back(i);
+                ++deferred;
+                continue;
+            }
+        }
+        if (!found) {
+            failed = i;
+            return false;
+        }
+        table.reserve(i, paths[i]);
+        deferred = 0;
+    }
+    return true;
+}
+
+template <typename Motion>
+void PrioritizedPlanning<Motion>::run() {
+    info("Running prioritized planning...");
+
+    // agents with longer distances first
+    const int N = P->getNum();
+    steps.resize(N);
+    for (int i = 0; i < N; ++i) computeSteps(steps[i], P->getGoal(i).node);
+    order.resize(N);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int i, int j) {return pathDist(i) > pathDist(j);});
+    num_restarts = 0;
+    num_expanded = 0;
+    solved = false;
+
+    for (int failed = -1; ; ++num_restarts) {
+        if (plan(failed)) {
+            addPaths(paths);
+            solved = true;
+            break;
+        }
+        if (overCompTime()) {
+            warn("Exceeded maximum computation time limit");
+            break;
+        } else if (stopRequested()) {
+            info("Stopped on request after " + std::to_string(num_restarts) + " restarts");
+            break;
+        } else if (num_restarts >= max_restarts) {
+            warn("No solution after " + std::to_string(num_restarts) + " restarts, agent "
+                + std::to_string(failed) + " failed");
+            break;
+        }
+        // failed agent first, the others in random order
+        RNG rng = RNG(seed, Stream::PRIORITY).derive(num_restarts);
+        order.erase(std::find(order.begin(), order.end(), failed));
+        randomShuffle(order.begin(), order.end(), rng);
+        order.insert(order.begin(), failed);
+        debug("Restart with agent " + std::to_string(failed) + " first");
+    }
+    table.clear();
+    steps.clear();
+}
+
+template class PrioritizedPlanning<Omnidirectional>;
+template class PrioritizedPlanning<Oriented>;
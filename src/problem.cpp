@@ -5,24 +5,25 @@ void MAPF_Instance::setRandomStartsGoals() {
     // create problem with randomized start and goal states
     config_s.clear(); config_g.clear();
     const int N = G->size();
+    RNG rng(seed, Stream::INSTANCE);
 
     std::vector<int> starts(N);
     std::iota(starts.begin(), starts.end(), 0);
-    std::shuffle(starts.begin(), starts.end(), *MT);
+    randomShuffle(starts.begin(), starts.end(), rng);
     int i = 0;
     while (true) {
         while (G->getNode(starts[i]) == nullptr) {
             ++i;
             if (i >= N) error("Too many agents");
         }
-        config_s.push_back({G->getNode(starts[i]), getRandomInt(0, 3, *MT)});
+        config_s.push_back({G->getNode(starts[i]), getRandomInt(0, 3, rng)});
         if ((int)config_s.size() == num_agents) break;
         ++i;
     }
 
     std::vector<int> goals(N);
     std::iota(goals.begin(), goals.end(), 0);
-    std::shuffle(goals.begin(), goals.end(), *MT);
+    randomShuffle(goals.begin(), goals.end(), rng);
     int j = 0;
     while (true) {
         while (G->getNode(goals[j]) == nullptr) {
@@ -31,13 +32,13 @@ void MAPF_Instance::setRandomStartsGoals() {
         }
         
         // lazy reinitialization
-        if (G->getNode(goals[j]) == config_s[config_g.size()].node) {
+        if (goals[j] == config_s[config_g.size()].id()) {
             config_g.clear();
-            std::shuffle(goals.begin(), goals.end(), *MT);
+            randomShuffle(goals.begin(), goals.end(), rng);
             j = 0;
             continue;
         }
-        config_g.push_back({G->getNode(goals[j]), getRandomInt(0, 3, *MT)});
+        config_g.push_back({G->getNode(goals[j]), getRandomInt(0, 3, rng)});
         if ((int)config_g.size() == num_agents) break;
         ++j;
     }
@@ -47,14 +48,44 @@ State MAPF_Instance::getStart(int i) const {
     if (!(0 <= i && i < (int)config_s.size())) {
         error("Agent index exceeded number of start states");
     }
-    return config_s[i];
+    return G->getState(config_s[i]);
 }
 
 State MAPF_Instance::getGoal(int i) const {
     if (!(0 <= i && i < (int)config_g.size())) {
         error("Agent index exceeded number of goal states");
     }
-    return config_g[i];
+    return G->getState(config_g[i]);
+}
+
+void MAPF_Instance::setStart(int i, const State& s) {
+    if (!(0 <= i && i < num_agents)) error("Agent index exceeded number of start states");
+    if (s.node == nullptr) error("Start state without node");
+    config_s[i] = s;
+    start_revision[i] = ++revision;
+}
+
+void MAPF_Instance::setGoal(int i, const State& g) {
+    if (!(0 <= i && i < num_agents)) error("Agent index exceeded number of goal states");
+    if (g.node == nullptr) error("Goal state without node");
+    config_g[i] = g;
+    goal_revision[i] = ++revision;
+}
+
+void MAPF_Instance::resetRevisions() {
+    ++revision;
+    start_revision.assign(num_agents, revision);
+    goal_revision.assign(num_agents, revision);
+}
+
+MotionModel MAPF_Instance::getMotionModel() const {
+    // agents without heading move omnidirectionally
+    int omni = 0;
+    for (auto& s : config_s) omni += (s.orientation() == -1);
+    for (auto& g : config_g) omni += (g.orientation() == -1);
+    if (omni == 0) return MotionModel::ORIENTED;
+    if (omni == 2 * num_agents) return MotionModel::OMNIDIRECTIONAL;
+    return MotionModel::MIXED;
 }
 
 void MAPF_Instance::make(int num_agents) {
@@ -62,6 +93,7 @@ void MAPF_Instance::make(int num_agents) {
     this->num_agents = num_agents;
     auto t_start = Time::now();
     setRandomStartsGoals();
+    resetRevisions();
     info("Generate random starts and goals", t_start);
 }
 
@@ -71,4 +103,5 @@ void MAPF_Instance::make(const Config& config_s, const Config& config_g, int num
     this->num_agents = num_agents;
     this->config_s = config_s;
     this->config_g = config_g;
+    resetRevisions();
 }
@@ -0,0 +1,94 @@
+#include "reservation.h"
+
+
+int ReservationTable::occupant(int t, int v) const {
+    auto itr = table.find(key(t, v));
+    if (itr != table.end()) return itr->second;
+    return (t <= hold_window) ? held[v] : -1;
+}
+
+bool ReservationTable::canMove(int t, Node* const u, Node* const v) const {
+    if (!isFree(t + 1, v)) return false;            // vertex conflict
+    if (u == v) return true;
+    int o = occupant(t, v->id);
+    return o == -1 || occupant(t + 1, u->id) != o;      // swap conflict
+}
+
+void ReservationTable::reserve(const int i, const Path& path) {
+    for (int t = 0; t < (int)path.size(); ++t) {
+        if (path[t].empty()) continue;
+        auto [itr, inserted] = table.emplace(key(t, path[t].id()), i);
+        if (!inserted && itr->second != i) {
+            warn("Agent " + std::to_string(i) + " reserved node " + std::to_string(path[t].id())
+                + " of agent " + std::to_string(itr->second) + " at timestep " + std::to_string(t));
+            itr->second = i;
+        }
+    }
+    horizon = std::max(horizon, (int)path.size());
+}
+
+void ReservationTable::release(const int i, const Path& path) {
+    for (int t = 0; t < (int)path.size(); ++t) {
+        if (path[t].empty()) continue;
+        auto itr = table.find(key(t, path[t].id()));
+        if (itr != table.end() && itr->second == i) table.erase(itr);
+    }
+}
+
+void ReservationTable::clear() {
+    table.clear();
+    horizon = 0;
+    std::fill(held.begin(), held.end(), -1);
+}
+
+template <typename Motion>
+bool SpaceTimeAStar<Motion>::findPath(const PackedState& start, const PackedState& goal, const std::function<int(Node*)>& h,
+    int max_timestep, Path& path, const std::function<bool()>& interrupted) {
+    struct Entry {
+        PackedState s;
+        int t;
+        int parent;
+    };
+    using cmp = std::tuple<int, int, int>;      // <f, -t, entry>, deeper first on ties
+    std::vector<Entry> entries;
+    std::priority_queue<cmp, std::vector<cmp>, std::greater<>> OPEN;
+    std::unordered_set<uint64_t> CLOSED;
+    // past the horizon nothing changes, so later copies of a state are redundant
+    const uint64_t num_states = 4 * (uint64_t)G->size();
+    auto slot = [&](int t, const PackedState& s) {return std::min(t, table.getHorizon()) * num_states + s.index();};
+
+    expanded = 0;
+    entries.push_back({start, 0, -1});
+    OPEN.push({h(G->getNode(start.id())), 0, 0});
+    std::array<State, 4> buf;
+    while (!OPEN.empty()) {
+        const int k = std::get<2>(OPEN.top()); OPEN.pop();
+        const Entry e = entries[k];
+        if (e.s == goal) {
+            path.assign(e.t + 1, PackedState());
+            for (int j = k; j != -1; j = entries[j].parent) path[entries[j].t] = entries[j].s;
+            return true;
+        }
+        if (!CLOSED.insert(slot(e.t, e.s)).second) continue;
+        if ((++expanded & 1023) == 0 && interrupted && interrupted()) return false;
+        if (e.t + 1 >= max_timestep) continue;
+
+        const State u = G->getState(e.s);
+        const int t = e.t + 1;
+        auto expand = [&](const State& v) {
+            if (v.node != u.node && G->getWeight(u.node, v.node) >= MAX_WEIGHT) return;
+            if (!table.canMove(e.t, u.node, v.node)) return;
+            PackedState q(v);
+            if (CLOSED.count(slot(t, q))) return;
+            entries.push_back({q, t, k});
+            OPEN.push({t + h(v.node), -t, (int)entries.size() - 1});
+        };
+        int cnt = Motion::getNeighbor(*G, u, buf);
+        for (int c = 0; c < cnt; ++c) expand(buf[c]);
+        expand(u);      // wait
+    }
+    return false;
+}
+
+template class SpaceTimeAStar<Omnidirectional>;
+template class SpaceTimeAStar<Oriented>;
@@ -2,6 +2,7 @@
 
 
 void MAPF_Solver::computeLowerBounds() {
+    if (distance_table->empty()) createDistanceTable();     // not solved yet
     LB_soc = 0;
     LB_makespan = 0;
     for (int i = 0; i < P->getNum(); ++i) {
@@ -12,11 +13,24 @@ void MAPF_Solver::computeLowerBounds() {
 }
 
 void MAPF_Solver::exec() {
-    createDistanceTable();
+    if (!distance_shared) createDistanceTable();
     precomp_time = getSolverElapsedTime();
     run();
 }
 
+void MAPF_Solver::addPaths(const std::vector<Path>& paths) {
+    // agents are absent after their paths end, they left at their goals
+    int T = 0;
+    for (auto& path : paths) T = std::max(T, (int)path.size());
+    for (int t = 0; t < T; ++t) {
+        Config config(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if (t < (int)paths[i].size()) config[i] = paths[i][t];
+        }
+        solution.add(config);
+    }
+}
+
 int MAPF_Solver::getLowerBoundSOC() {
     if (LB_soc == 0) computeLowerBounds();
     return LB_soc;
@@ -29,45 +43,104 @@ int MAPF_Solver::getLowerBoundMakespan() {
 
 int MAPF_Solver::pathDist(Node* const u, Node* const v) const {
     if (u == v) return 0;
-    auto [path, cost] = G->getPathWithCost(State(u), State(v), MT);
+    RNG rng = RNG(seed, Stream::SEARCH).derive(u->id, v->id);
+    auto [path, cost] = G->getPathWithCost(State(u), State(v), &rng);
     return path.size() - 1;
 }
 
 int MAPF_Solver::pathDist(const int i, Node* const u) const {
-    return distance_table[i][u->id];
+    return (*distance_table)[i][u->id];
 }
 
 int MAPF_Solver::pathDist(const int i) const {
     return pathDist(i, P->getStart(i).node);
 }
 
-void MAPF_Solver::createDistanceTable() {
-    // for each agent, precompute distance-to-goal using backward dijkstra
+void MAPF_Solver::computeDistance(std::vector<int>& row, Node* const g) const {
+    // distance-to-goal of every node using backward dijkstra
     using cmp = std::tuple<float, int, Node*>;      // <cost, step, node>
-    std::vector<float> tmp(G->size());      // temporary cost-map
-    distance_table.resize(P->getNum(), std::vector<int>(G->size(), max_timestep));
-    for (int i = 0; i < P->getNum(); ++i) {
-        // initialize cost-map
-        tmp.assign(tmp.size(), MAX_WEIGHT);
-        std::priority_queue<cmp, std::vector<cmp>, std::greater<>> OPEN;
-        Node* g = P->getGoal(i).node;
-        distance_table[i][g->id] = 0;
-        tmp[g->id] = 0.f;
-        OPEN.push({0.f, 0, g});
-        while (!OPEN.empty()) {
-            auto [cn, dn, n] = OPEN.top(); OPEN.pop();
-            if (cn > tmp[n->id]) continue;
-            for (auto m : n->neighbor) {
-                if (G->getWeight(m, n) >= MAX_WEIGHT) continue;
-                float cm = cn + G->getWeight(m, n);
-                int dm = dn + 1;
-                if (cm < tmp[m->id]) {
-                    tmp[m->id] = cm;
-                    distance_table[i][m->id] = dm;
-                    OPEN.push({cm, dm, m});
-                }
-
+    std::vector<float> tmp(G->size(), MAX_WEIGHT);      // temporary cost-map
+    std::priority_queue<cmp, std::vector<cmp>, std::greater<>> OPEN;
+    row.assign(G->size(), max_timestep);
+    row[g->id] = 0;
+    tmp[g->id] = 0.f;
+    OPEN.push({0.f, 0, g});
+    while (!OPEN.empty()) {
+        auto [cn, dn, n] = OPEN.top(); OPEN.pop();
+        if (cn > tmp[n->id]) continue;
+        for (auto m : n->neighbor) {
+            if (G->getWeight(m, n) >= MAX_WEIGHT) continue;
+            float cm = cn + G->getWeight(m, n);
+            int dm = dn + 1;
+            if (cm < tmp[m->id]) {
+                tmp[m->id] = cm;
+                row[m->id] = dm;
+                OPEN.push({cm, dm, m});
             }
         }
     }
-}
\ No newline at end of file
+}
+
+void MAPF_Solver::computeSteps(std::vector<int>& row, Node* const g) const {
+    // breadth-first search backwards over passable edges; weighted rows count the
+    // steps of the cheapest path, which may exceed this and so overestimate
+    row.assign(G->size(), max_timestep);
+    row[g->id] = 0;
+    std::queue<Node*> OPEN;
+    OPEN.push(g);
+    for (; !OPEN.empty(); OPEN.pop()) {
+        Node* const n = OPEN.front();
+        for (auto m : n->neighbor) {
+            if (row[m->id] != max_timestep || G->getWeight(m, n) >= MAX_WEIGHT) continue;
+            row[m->id] = row[n->id] + 1;
+            OPEN.push(m);
+        }
+    }
+}
+
+void MAPF_Solver::createDistanceTable() {
+    // for each agent, precompute distance-to-goal
+    // fresh table, so that solvers sharing the previous one are unaffected
+    auto table = std::make_shared<DistanceTable>(P->getNum());
+    for (int i = 0; i < P->getNum(); ++i) {
+        computeDistance((*table)[i], P->getGoal(i).node);
+    }
+    distance_table = table;
+    distance_shared = false;
+    clearDistanceCache();       // cached rows follow the previous weights
+}
+
+void MAPF_Solver::updateDistance(const int i, Node* const g) {
+    if (!(0 <= i && i < (int)distance_table->size())) error("Invalid agent index; Failed to update distance");
+    // copy on write while the table is shared with other solvers
+    if (distance_table.use_count() > 1) distance_table = std::make_shared<DistanceTable>(*distance_table);
+    auto itr = distance_cache.find(g->id);
+    if (itr != distance_cache.end()) {
+        (*distance_table)[i] = itr->second.first;
+        cache_order.splice(cache_order.end(), cache_order, itr->second.second);     // most recently used
+        return;
+    }
+    computeDistance((*distance_table)[i], g);
+    if (cache_capacity == 0) return;
+    trimDistanceCache(cache_capacity - 1);
+    cache_order.push_back(g->id);
+    distance_cache.emplace(g->id, std::make_pair((*distance_table)[i], std::prev(cache_order.end())));
+}
+
+void MAPF_Solver::trimDistanceCache(const size_t n) {
+    while (distance_cache.size() > n) {
+        distance_cache.erase(cache_order.front());
+        cache_order.pop_front();
+    }
+}
+
+void MAPF_Solver::setDistanceCacheCapacity(const size_t n) {
+    cache_capacity = n;
+    trimDistanceCache(cache_capacity);
+}
+
+void MAPF_Solver::shareDistanceTable(std::shared_ptr<DistanceTable> table) {
+    if (table == nullptr || (int)table->size() != P->getNum()) error("Distance table does not match instance");
+    distance_table = table;
+    distance_shared = true;
+}
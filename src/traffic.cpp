@@ -0,0 +1,154 @@
+#include "traffic.h"
+#include "pibt.h"
+
+
+TrafficStats::TrafficStats(const Grid* G) : G(G) {
+    clear();
+}
+
+void TrafficStats::clear() {
+    flows.assign(G->size() * 4, 0);
+    visits.assign(G->size(), 0);
+    waits.assign(G->size(), 0);
+    steps = 0;
+    num_plans = 0;
+}
+
+void TrafficStats::record(const Plan& plan) {
+    if (plan.getG() == nullptr || plan.getG()->size() != G->size()) error("Plan of another graph");
+    for (int i = 0; i < plan.size(); ++i) {
+        const Path path = plan.getPath(i);
+        for (int t = 0; t < (int)path.size(); ++t) {
+            if (path[t].empty()) continue;
+            ++visits[path[t].id()];
+            if (t + 1 == (int)path.size() || path[t + 1].empty()) continue;
+            ++steps;
+            const Node* u = G->getNode(path[t].id());
+            const Node* v = G->getNode(path[t + 1].id());
+            if (u == v) {
+                ++waits[u->id];
+                continue;
+            }
+            const int ch = Heading::of(v->pos.x - u->pos.x, v->pos.y - u->pos.y);
+            if (ch == -1) error("Plan with a jump between nodes");
+            ++flows[u->id * 4 + ch];
+        }
+    }
+    ++num_plans;
+}
+
+int TrafficStats::getContraFlow(Node* const u, const int ch) const {
+    const int x = u->pos.x + Heading::DX[ch];
+    const int y = u->pos.y + Heading::DY[ch];
+    if (!G->existNode(x, y)) return 0;
+    return flows[G->getNode(x, y)->id * 4 + (ch + 2) % 4];
+}
+
+float TrafficStats::getWaitRatio() const {
+    if (steps == 0) return 0.f;
+    int64_t cnt = 0;
+    for (auto w : waits) cnt += w;
+    return (float)cnt / steps;
+}
+
+template <typename Motion>
+GuidanceOptimizer<Motion>::GuidanceOptimizer(Grid* G, int num_agents, const std::vector<State>& tasks, int horizon, uint64_t seed) :
+    G(G),
+    num_agents(num_agents),
+    tasks(tasks),
+    horizon(horizon),
+    seed(seed),
+    initial(G->getWeights()),
+    contra_flow_penalty(1.f),
+    congestion_penalty(1.f),
+    max_weight(5.f),
+    stats(G),
+    best_throughput(0.f) {
+        if (G->getChannels() != 4) error("Guidance needs a graph with weights");
+        for (auto& g : tasks) {
+            if (g.node == nullptr) error("Invalid task state");
+            // a task without heading would keep oriented agents turning at its goal
+            if (!Motion::isValidOrientation(g.orientation)) {
+                error("Task orientation " + std::to_string(g.orientation) + " is invalid for " + Motion::name + " agents");
+            }
+        }
+    }
+
+template <typename Motion>
+float GuidanceOptimizer<Motion>::evaluate() {
+    // same starts and task sequence every time, so only the weights differ
+    MAPF_Instance L(G, seed, horizon, INT_MAX);
+    L.make(num_agents);
+    if constexpr (std::is_same_v<Motion, Omnidirectional>) {
+        // random instances come with headings
+        Config starts = L.getConfigStart(), goals = L.getConfigGoal();
+        for (auto& s : starts) s = PackedState(G->getNode(s.id()), -1);
+        for (auto& g : goals) g = PackedState(G->getNode(g.id()), -1);
+        L.make(starts, goals, num_agents);
+    }
+    GoalQueue queue;
+    for (auto& g : tasks) queue.push(g);
+    PIBT<Motion> pibt(&L);
+    pibt.setGoalProvider(queue.provider());
+    pibt.solve();
+    stats.clear();
+    stats.record(pibt.getSolution());
+    history.push_back(pibt.getThroughput());
+    return history.back();
+}
+
+template <typename Motion>
+std::vector<float> GuidanceOptimizer<Motion>::propose(const std::vector<float>& base, const float step) const {
+    // moves against the dominant direction of an edge and into cells where
+    // agents wait become more expensive; weights move towards the target by step
+    int max_waits = 0;
+    for (int k = 0; k < G->size(); ++k) {
+        if (G->existNode(k)) max_waits = std::max(max_waits, stats.getWaits(G->getNode(k)));
+    }
+    std::vector<float> weights = base;
+    for (int k = 0; k < G->size(); ++k) {
+        if (!G->existNode(k)) continue;
+        Node* u = G->getNode(k);
+        for (int ch = 0; ch < 4; ++ch) {
+            const int x = u->pos.x + Heading::DX[ch], y = u->pos.y + Heading::DY[ch];
+            if (base[k * 4 + ch] >= MAX_WEIGHT || !G->existNode(x, y)) continue;
+            Node* v = G->getNode(x, y);
+            const int f = stats.getFlow(u, ch);
+            const int r = stats.getContraFlow(u, ch);
+            const float contra = (r > f) ? (float)(r - f) / (r + f) : 0.f;
+            const float congestion = (max_waits > 0) ? (float)stats.getWaits(v) / max_waits : 0.f;
+            const float target = initial[k * 4 + ch] * (1.f + contra_flow_penalty * contra + congestion_penalty * congestion);
+            float& w = weights[k * 4 + ch];
+            w = std::min(max_weight, w + step * (target - w));
+        }
+    }
+    return weights;
+}
+
+template <typename Motion>
+float GuidanceOptimizer<Motion>::optimize(const int iterations) {
+    best = G->getWeights();
+    best_throughput = evaluate();
+    TrafficStats best_stats = stats;
+    info("Initial throughput " + std::to_string(best_throughput));
+    float step = 1.f;
+    for (int it = 0; it < iterations; ++it) {
+        std::vector<float> candidate = propose(best, step);
+        G->setWeights(candidate);
+        const float throughput = evaluate();
+        if (throughput > best_throughput) {
+            best = candidate;
+            best_throughput = throughput;
+            best_stats = stats;
+            info("Throughput " + std::to_string(throughput) + " at iteration " + std::to_string(it));
+        } else {
+            stats = best_stats;
+            step *= 0.5f;
+        }
+    }
+    G->setWeights(best);
+    return best_throughput;
+}
+
+template class GuidanceOptimizer<Omnidirectional>;
+template class GuidanceOptimizer<Oriented>;
@@ -0,0 +1,192 @@
+#include "tswap.h"
+
+
+template <typename Motion>
+void TSWAP<Motion>::assignGoals() {
+    // greedy on increasing distance, rows of the distance table are the fields of the goals;
+    // each agent keeps a short list of its nearest free goals, refilled with twice the
+    // length once taken goals used it up, and a heap yields the globally nearest pair
+    const int N = P->getNum();
+    const Config& starts = P->getConfigStart();
+    assignment.assign(N, -1);
+    std::vector<bool> taken(N, false);
+    using Candidate = std::pair<int, int>;      // <distance, goal>
+    std::vector<std::vector<Candidate>> nearest(N);
+    std::vector<size_t> head(N, 0);
+    std::vector<size_t> length(N, 8);
+    std::vector<Candidate> buf;
+    auto refill = [&](int i) {
+        Node* s = G->getNode(starts[i].id());
+        buf.clear();
+        for (int k = 0; k < N; ++k) {
+            if (!taken[k]) buf.emplace_back(pathDist(k, s), k);
+        }
+        const size_t n = std::min(buf.size(), length[i]);
+        std::partial_sort(buf.begin(), buf.begin() + n, buf.end());
+        nearest[i].assign(buf.begin(), buf.begin() + n);
+        head[i] = 0;
+        length[i] *= 2;
+    };
+
+    using Pair = std::tuple<int, int, int>;     // <distance, agent, goal>
+    std::priority_queue<Pair, std::vector<Pair>, std::greater<>> OPEN;
+    for (int i = 0; i < N; ++i) {
+        refill(i);
+        OPEN.push({nearest[i][0].first, i, nearest[i][0].second});
+    }
+    while (!OPEN.empty()) {
+        auto [d, i, k] = OPEN.top(); OPEN.pop();
+        if (!taken[k]) {
+            assignment[i] = k;
+            taken[k] = true;
+            nearest[i].clear();
+            continue;
+        }
+        // goal went to a closer pair; an unassigned agent always has a free goal left
+        while (head[i] < nearest[i].size() && taken[nearest[i][head[i]].second]) ++head[i];
+        if (head[i] == nearest[i].size()) refill(i);
+        OPEN.push({nearest[i][head[i]].first, i, nearest[i][head[i]].second});
+    }
+}
+
+template <typename Motion>
+Node* TSWAP<Motion>::getNextNode(const Config& C, const int i) const {
+    // neighbor closest to the goal, forward first on ties
+    const State curr = G->getState(C[i]);
+    Node* const g = G->getNode(P->getConfigGoal()[assignment[i]].id());
+    if (curr.node == g) return g;
+    Node* const fwd = Motion::forward(*G, curr);
+    Nodes V;
+    for (auto v : curr.node->neighbor) {
+        if (G->getWeight(curr.node, v) < MAX_WEIGHT) V.push_back(v);
+    }
+    RNG rng = RNG(seed, Stream::TIEBREAK).derive(i, timestep);
+    randomShuffle(V.begin(), V.end(), rng);
+    Node* best = curr.node;
+    for (auto v : V) {
+        int dv = dist(i, v), db = dist(i, best);
+        if (dv < db || (dv == db && v == fwd)) best = v;
+    }
+    return best;
+}
+
+template <typename Motion>
+void TSWAP<Motion>::resolve(const Config& C, const int i) {
+    // agent i is blocked; follow the agents ahead while each one is blocked by the next
+    Node* u = getNextNode(C, i);
+    int j = occupied[u->id];
+    if (j == -1 || j == i) return;
+
+    // exchange goals with the blocking agent when both get closer overall
+    if (!atGoal(C, j)) {
+        Node* vi = G->getNode(C[i].id());
+        Node* vj = G->getNode(C[j].id());
+        if (pathDist(assignment[j], vi) + pathDist(assignment[i], vj) < dist(i, vi) + dist(j, vj)) {
+            std::swap(assignment[i], assignment[j]);
+            ++num_swaps;
+            return;
+        }
+    }
+
+    // deadlock: the chain closes at i, every agent passes its goal to the agent ahead
+    std::vector<int> chain = {i};
+    std::unordered_set<int> visited = {i};
+    for (int x = j; ; ) {
+        if (atGoal(C, x) || !visited.insert(x).second) return;
+        chain.push_back(x);
+        int y = occupied[getNextNode(C, x)->id];
+        if (y == -1 || y == x) return;
+        if (y == i) break;
+        x = y;
+    }
+    int last = assignment[chain.back()];
+    for (int k = (int)chain.size() - 1; k > 0; --k) assignment[chain[k]] = assignment[chain[k - 1]];
+    assignment[chain.front()] = last;
+    num_swaps += (int)chain.size() - 1;
+}
+
+template <typename Motion>
+void TSWAP<Motion>::step(const Config& C, Config& Q) {
+    const int N = P->getNum();
+    Q.assign(N, PackedState());
+    for (int i = 0; i < N; ++i) {
+        if (!C[i].empty()) occupied[C[i].id()] = i;
+    }
+    for (int i = 0; i < N; ++i) {
+        if (!C[i].empty() && !atGoal(C, i)) resolve(C, i);
+    }
+
+    // agents at goals leave; the others move in turn into free nodes
+    for (int i = 0; i < N; ++i) {
+        if (!C[i].empty() && atGoal(C, i)) occupied[C[i].id()] = -1;
+    }
+    for (int i = 0; i < N; ++i) {
+        if (C[i].empty() || atGoal(C, i)) continue;
+        const State s = G->getState(C[i]);
+        Node* u = getNextNode(C, i);
+        Q[i] = C[i];
+        switch (Motion::getAction(s, u, P->getGoal(assignment[i]))) {
+            case Action::TURN_LEFT : Q[i] = State(s.node, Heading::LEFT[s.orientation]); break;
+            case Action::TURN_RIGHT : Q[i] = State(s.node, Heading::RIGHT[s.orientation]); break;
+            case Action::MOVE :
+                if (occupied[u->id] == -1) {
+                    occupied[s.node->id] = -1;
+                    occupied[u->id] = i;
+                    Q[i] = State(u, s.orientation);
+                }
+                break;
+            case Action::NONE : error("Agent intent to make an invalid move");
+            default : break;
+        }
+    }
+    for (int i = 0; i < N; ++i) {
+        if (!Q[i].empty()) occupied[Q[i].id()] = -1;
+    }
+}
+
+template <typename Motion>
+void TSWAP<Motion>::run() {
+    info("Running TSWAP...");
+
+    assignGoals();
+    num_swaps = 0;
+    timestep = 0;
+    solved = false;
+    const int N = P->getNum();
+    Config C = P->getConfigStart();
+    solution.add(C);
+    while (true) {
+        bool done = true;
+        for (int i = 0; i < N && done; ++i) done = C[i].empty() || atGoal(C, i);
+        if (done) {
+            solved = true;
+            break;
+        }
+        if (timestep >= max_timestep) {
+            warn("Exceeded maximum number of timesteps");
+            break;
+        } else if (overCompTime()) {
+            warn("Exceeded maximum computation time limit");
+            break;
+        } else if (stopRequested()) {
+            info("Stopped on request at timestep " + std::to_string(timestep));
+            break;
+        }
+        Config Q;
+        step(C, Q);
+        solution.add(Q);
+        C = std::move(Q);
+        ++timestep;
+    }
+    info("Swapped goals " + std::to_string(num_swaps) + " times");
+}
+
+template <typename Motion>
+Config TSWAP<Motion>::getAssignedGoals() const {
+    Config goals(assignment.size());
+    for (size_t i = 0; i < assignment.size(); ++i) goals[i] = P->getConfigGoal()[assignment[i]];
+    return goals;
+}
+
+template class TSWAP<Omnidirectional>;
+template class TSWAP<Oriented>;
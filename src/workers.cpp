@@ -0,0 +1,66 @@
+#include "workers.h"
+
+
+WorkerPool::WorkerPool(int num_threads) :
+    round(0),
+    pending(0),
+    stopping(false) {
+        if (num_threads < 1) error("Pool needs at least one thread");
+        for (int w = 1; w < num_threads; ++w) threads.emplace_back(&WorkerPool::loop, this);
+    }
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) thread.join();
+}
+
+void WorkerPool::loop() {
+    uint64_t seen = 0;
+    while (true) {
+        std::function<void()> fn;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            wake.wait(lock, [&]() {return stopping || round != seen;});
+            if (stopping) return;
+            seen = round;
+            fn = job;
+        }
+        try {
+            fn();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!failure) failure = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        if (--pending == 0) idle.notify_one();
+    }
+}
+
+void WorkerPool::run(const std::function<void()>& fn) {
+    if (threads.empty()) {
+        fn();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        job = fn;
+        pending = (int)threads.size();
+        failure = nullptr;
+        ++round;
+    }
+    wake.notify_all();
+    std::exception_ptr own;
+    try {
+        fn();
+    } catch (...) {
+        own = std::current_exception();
+    }
+    std::unique_lock<std::mutex> lock(mtx);
+    idle.wait(lock, [&]() {return pending == 0;});
+    if (own) std::rethrow_exception(own);
+    if (failure) std::rethrow_exception(failure);
+}
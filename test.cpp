@@ -1,4 +1,5 @@
 #include <cassert>
+#include <cstring>
 #include <filesystem>
 
 #include "logger.h"
@@ -6,6 +7,17 @@
 #include "problem.h"
 #include "solver.h"
 #include "pibt.h"
+#include "lacam.h"
+#include "lns.h"
+#include "planio.h"
+#include "mapf_c.h"
+#include "batch.h"
+#include "portfolio.h"
+#include "pp.h"
+#include "reservation.h"
+#include "tswap.h"
+#include "adg.h"
+#include "traffic.h"
 
 
 template <typename... Args>
@@ -18,6 +30,19 @@ inline void warn(const std::string& msg, Args&&... args) {
     Logger::get().log(LogLevel::WARN, "TEST", msg, std::forward<Args>(args)...);
 }
 
+// drops the headings of all agents of P and solves it again; the caller validates and deletes
+inline MAPF_Solver* solve_omnidirectional(MAPF_Instance* P, const Parameters& params) {
+    const Grid* G = P->getG();
+    Config config_s = P->getConfigStart(), config_g = P->getConfigGoal();
+    for (auto& s : config_s) s = PackedState(G->getNode(s.id()), -1);
+    for (auto& g : config_g) g = PackedState(G->getNode(g.id()), -1);
+    P->make(config_s, config_g, P->getNum());
+    MAPF_Solver* mapf = make_solver(P, params);
+    mapf->solve();
+    assert(mapf->succeed() == true);
+    return mapf;
+}
+
 void test_graph() {
     auto t_start = Time::now();
 
@@ -65,6 +90,15 @@ void test_graph() {
     assert(G->getNeighbor(State(G->getNode(1, 1), 1), buf) == 3);
     assert(G->getNeighbor(State(G->getNode(1, 1)), buf) == 4);
 
+    PackedState p(G->getNode(6, 2), 1);
+    assert(p.id() == G->getNode(6, 2)->id);
+    assert(p.orientation() == 1);
+    assert(G->getState(p) == State(G->getNode(6, 2), 1));
+    assert(PackedState(G->getNode(6, 2)).orientation() == -1);
+    assert(G->getState(PackedState(G->getNode(6, 2))) == State(G->getNode(6, 2)));
+    assert(PackedState().empty());
+    assert(G->getState(PackedState()).node == nullptr);
+
     assert(G->dist(G->getNode(0, 0), G->getNode(34, 20)) == 54);
     assert(G->getPathWithCost(State(G->getNode(0, 0), 0), State(G->getNode(34, 20), 3)).first.size() == 56);
     assert(G->getPathWithCost(State(G->getNode(0, 0), 0), State(G->getNode(34, 20), 3)).second == 55);
@@ -80,12 +114,12 @@ void test_problem() {
     auto t_start = Time::now();
 
     Grid* G = new Grid("assets/warehouse", true);
-    std::mt19937* MT = new std::mt19937(42);
+    uint64_t seed = 42;
     int max_timestep = 10000;
     int max_comp_time = 1000;
-    MAPF_Instance* P = new MAPF_Instance(G, MT, max_timestep, max_comp_time);
+    MAPF_Instance* P = new MAPF_Instance(G, seed, max_timestep, max_comp_time);
     assert(P->getG() == G);
-    assert(P->getMT() == MT);
+    assert(P->getSeed() == 42);
     assert(P->getInstanceFileName() == "custom");
     assert(P->getMaxTimestep() == 10000);
     assert(P->getMaxCompTime() == 1000);
@@ -102,6 +136,15 @@ void test_problem() {
     assert(P->getNum() == 200);
     assert(P->getConfigStart().size() == 200);
     assert(P->getConfigGoal().size() == 200);
+
+    MAPF_Instance* Q = new MAPF_Instance(G, seed, max_timestep, max_comp_time);
+    Q->make(200);
+    assert(Q->getConfigStart() == P->getConfigStart());
+    assert(Q->getConfigGoal() == P->getConfigGoal());
+    Q->setSeed(7);
+    Q->make(200);
+    assert(Q->getConfigStart() != P->getConfigStart());
+    delete Q;
     debug("Random problem instance ... [OK]", t_start);
 
     t_start = Time::now();
@@ -126,17 +169,224 @@ void test_problem() {
     assert(G->getPathWithCost(P->getStart(0), P->getGoal(0)).first.size() == 38);
     assert(G->getPathWithCost(P->getStart(0), P->getGoal(0)).second == 37);
     debug("Custom problem instance ... [OK]", t_start);
-    delete P; delete G; delete MT;
+    delete P; delete G;
+}
+
+void test_plan() {
+    auto t_start = Time::now();
+
+    Grid* G = new Grid("assets/warehouse", true);
+    Plan plan(G);
+    assert(plan.empty() == true);
+    assert(plan.getG() == G);
+
+    // random walk, teleports and an agent leaving at timestep 150
+    RNG rng(42);
+    const int T = 300;
+    std::vector<Path> paths(3);
+    State walker(G->getNode(0, 0), 0);
+    for (int t = 0; t < T; ++t) {
+        std::array<State, 4> buf;
+        int cnt = G->getNeighbor(walker, buf);
+        int k = getRandomInt(0, cnt, rng);
+        if (t > 0 && k < cnt) walker = buf[k];
+        Node* v = nullptr;
+        while (v == nullptr) v = G->getNode(getRandomInt(0, G->size() - 1, rng));
+        paths[0].push_back(walker);
+        paths[1].push_back(PackedState(v, getRandomInt(-1, 3, rng)));
+        paths[2].push_back(t < 150 ? PackedState(G->getNode(34, 20), 2) : PackedState());
+        plan.add({paths[0][t], paths[1][t], paths[2][t]});
+    }
+    assert(plan.size() == 3);
+    assert(plan.getMakespan() == T - 1);
+    assert(plan.getPath(0) == paths[0]);
+    assert(plan.getPath(1) == paths[1]);
+    assert(plan.getPath(2) == Path(paths[2].begin(), paths[2].begin() + 150));
+    for (int t = 0; t < T; t += 7) {
+        for (int i = 0; i < 3; ++i) {
+            assert(plan.getReader(i, t).get() == paths[i][t]);
+        }
+    }
+    assert(plan.getMemoryUsage() < T * 3 * sizeof(State));
+    assert(plan.getPathLength(0) == T && plan.getPathLength(2) == 150);
+    std::vector<int32_t> states(T * 3 * 3);
+    plan.exportStates(states.data());
+    for (int t = 0; t < T; t += 3) {
+        State s = G->getState(paths[1][t]);
+        assert(states[(t * 3 + 1) * 3] == s.node->pos.x);
+        assert(states[(t * 3 + 1) * 3 + 1] == s.node->pos.y);
+        assert(states[(t * 3 + 1) * 3 + 2] == s.orientation);
+        assert(states[(t * 3 + 2) * 3] == (t < 150 ? 34 : -1));
+    }
+    debug("Action stream plan ... [OK]", t_start);
+
+    // binary format, several blocks
+    t_start = Time::now();
+    plan.saveBinary("test.bplan", 64);
+    {
+        PlanReader reader("test.bplan");
+        assert(reader.size() == 3);
+        assert(reader.getMakespan() == T - 1);
+        assert(reader.getWidth() == G->getWidth() && reader.getHeight() == G->getHeight());
+        assert(reader.getMapHash() == G->getHash());
+        for (int i = 0; i < 3; ++i) assert(reader.getPath(i) == plan.getPath(i));
+        for (int t = 0; t < T; t += 5) {
+            for (int i = 0; i < 3; ++i) assert(reader.get(t, i) == paths[i][t]);
+        }
+        Plan loaded = reader.toPlan(G);
+        assert(loaded.getMakespan() == plan.getMakespan());
+        for (int i = 0; i < 3; ++i) assert(loaded.getPath(i) == plan.getPath(i));
+
+        // states are only resolved on the map the plan was made for
+        std::ofstream("test_small.map") << "height 2\nwidth 2\nmap\n..\n..\n";
+        Grid small("test_small");
+        std::filesystem::remove("test_small.map");
+        reader.checkMap(G);
+        bool raised = false;
+        try {
+            reader.checkMap(&small);
+        } catch (const MAPFError&) {
+            raised = true;
+        }
+        assert(raised);
+    }
+    // corrupted layouts are rejected when the file is opened
+    std::vector<char> bytes(std::filesystem::file_size("test.bplan"));
+    std::ifstream("test.bplan", std::ios::binary).read(bytes.data(), bytes.size());
+    auto rejected = [&](size_t pos, uint64_t value, size_t width) {
+        std::vector<char> copy = bytes;
+        std::memcpy(copy.data() + pos, &value, width);
+        std::ofstream("test.bplan", std::ios::binary | std::ios::trunc).write(copy.data(), copy.size());
+        try {
+            PlanReader reader("test.bplan");
+        } catch (const MAPFError&) {
+            return true;
+        }
+        return false;
+    };
+    const size_t footer = bytes.size() - PLAN_FOOTER_SIZE;
+    assert(rejected(32, 0, 4));                     // block size
+    assert(rejected(footer, 1ull << 60, 8));        // number of blocks
+    assert(rejected(footer - 8, bytes.size(), 8));  // offset of last block
+    assert(rejected(footer + 8, T + 100, 8));       // number of timesteps
+    assert(rejected(PLAN_HEADER_SIZE + 8 + 8 * 3, 1ull << 40, 8));     // end of agent streams
+    std::filesystem::remove("test.bplan");
+
+    // failed writes are raised instead of leaving a truncated file
+    if (std::filesystem::exists("/dev/full")) {
+        Plan full(G);
+        full.stream("/dev/full", 64);
+        bool raised = false;
+        try {
+            full.assign(plan);
+            full.closeStream();
+        } catch (const MAPFError&) {
+            raised = true;
+        }
+        assert(raised);
+        full.closeStream();     // nothing left to close
+    }
+    debug("Binary plan ... [OK]", t_start);
+
+    // errors are raised instead of terminating
+    bool raised = false;
+    try {
+        Plan().getPath(0);
+    } catch (const MAPFError&) {
+        raised = true;
+    }
+    assert(raised);
+
+    // conflicts
+    t_start = Time::now();
+    MAPF_Instance* P = new MAPF_Instance(G, 42, 10000, 1000);
+    Config a{{G->getNode(0, 0), 3}, {G->getNode(2, 0), 1}};
+    Config b{{G->getNode(1, 0), 3}, {G->getNode(1, 0), 1}};
+    P->make(a, b, 2);
+    Plan vertex(G);
+    vertex.add(a); vertex.add(b);
+    Conflicts conflicts = vertex.findConflicts(P);
+    assert(conflicts.size() == 1);
+    assert(conflicts[0].type == ConflictType::VERTEX);
+    assert(conflicts[0].t == 1 && conflicts[0].i == 0 && conflicts[0].j == 1);
+    assert(vertex.validate(P) == false);
+
+    a = {{G->getNode(0, 0), 3}, {G->getNode(1, 0), 1}};
+    b = {{G->getNode(1, 0), 3}, {G->getNode(0, 0), 1}};
+    Config c{{G->getNode(5, 5), 3}, {G->getNode(0, 0), 1}};
+    P->make(a, c, 2);
+    Plan edge(G);
+    edge.add(a); edge.add(b); edge.add(c);
+    conflicts = edge.findConflicts(P, 2);
+    assert(conflicts.size() == 2);
+    assert(conflicts[0].type == ConflictType::EDGE && conflicts[0].t == 1);
+    assert(conflicts[1].type == ConflictType::TRANSITION && conflicts[1].t == 2 && conflicts[1].i == 0);
+
+    // agents may return from where they left
+    a = {{G->getNode(0, 0), 3}, {G->getNode(2, 0), 1}};
+    b = {{G->getNode(0, 0), 3}, {G->getNode(5, 5), 1}};
+    P->make(a, b, 2);
+    Plan returned(G);
+    returned.add(a);
+    returned.add({PackedState(), PackedState()});
+    returned.add(b);
+    returned.add({PackedState(), PackedState()});
+    conflicts = returned.findConflicts(P);
+    assert(conflicts.size() == 1);
+    assert(conflicts[0].type == ConflictType::TRANSITION && conflicts[0].t == 2 && conflicts[0].i == 1);
+    Path path = returned.getPath(0);
+    assert(path.size() == 3 && path[0] == a[0] && path[1].empty() && path[2] == a[0]);
+    assert(returned.getPathLength(0) == 3);
+
+    // threaded check, conflicts across the chunk boundaries at 101, 201 and 301
+    a = {G->getNode(0, 0), G->getNode(1, 0)};
+    Config swapped{G->getNode(1, 0), G->getNode(0, 0)};
+    Config shared{G->getNode(0, 0), G->getNode(0, 0)};
+    Config jumped{G->getNode(5, 5), G->getNode(1, 0)};
+    P->make(a, a, 2);
+    Plan chunked(G);
+    for (int t = 0; t <= 400; ++t) {
+        if (t == 100) chunked.add(swapped);
+        else if (t == 200 || t == 201) chunked.add(shared);
+        else if (t == 300) chunked.add(jumped);
+        else chunked.add(a);
+    }
+    Conflicts serial = chunked.findConflicts(P, 1);
+    Conflicts threaded = chunked.findConflicts(P, 4);
+    assert(serial.size() == 6);
+    assert(threaded.size() == serial.size());
+    for (size_t k = 0; k < serial.size(); ++k) {
+        assert(threaded[k].type == serial[k].type && threaded[k].t == serial[k].t);
+        assert(threaded[k].i == serial[k].i && threaded[k].j == serial[k].j);
+    }
+    assert(serial[0].type == ConflictType::EDGE && serial[0].t == 100);
+    assert(serial[1].type == ConflictType::EDGE && serial[1].t == 101);
+    assert(serial[2].type == ConflictType::VERTEX && serial[2].t == 200);
+    assert(serial[3].type == ConflictType::VERTEX && serial[3].t == 201);
+    assert(serial[4].type == ConflictType::TRANSITION && serial[4].t == 300);
+    assert(serial[5].type == ConflictType::TRANSITION && serial[5].t == 301);
+
+    // mixed headings are rejected before any thread starts
+    P->make(a, Config{{G->getNode(0, 0), 3}, G->getNode(1, 0)}, 2);
+    raised = false;
+    try {
+        chunked.findConflicts(P, 4);
+    } catch (const MAPFError&) {
+        raised = true;
+    }
+    assert(raised);
+    debug("Plan conflicts ... [OK]", t_start);
+    delete P; delete G;
 }
 
 void test_solver() {
     auto t_start = Time::now();
 
     Grid* G = new Grid("assets/warehouse", true);
-    std::mt19937* MT = new std::mt19937(42);
+    uint64_t seed = 42;
     int max_timestep = 10000;
     int max_comp_time = 1000;
-    MAPF_Instance* P = new MAPF_Instance(G, MT, max_timestep, max_comp_time);
+    MAPF_Instance* P = new MAPF_Instance(G, seed, max_timestep, max_comp_time);
     P->make(100);
     MAPF_Solver* baseline = new MAPF_Solver(P);
 
@@ -146,22 +396,17 @@ void test_solver() {
     assert(baseline->getPreCompTime() == 0);
     assert(baseline->getCompTime() == 0);
     assert(baseline->getP() == P);
-    assert(baseline->getDistanceTable().size() == 100);
-
-    auto D1 = baseline->getDistanceTable();
-    int sum = 0;
-    for (int i = 0; i < P->getNum(); ++i) {
-        sum += std::accumulate(D1[i].begin(), D1[i].end(), 0);
-    }
-    assert(sum == 735000000);
+    assert(baseline->getDistanceTable().size() == 0);       // allocated when solving, or shared
 
     baseline->createDistanceTable();
-    auto D2 = baseline->getDistanceTable();
-    sum = 0;
+    const auto& D = baseline->getDistanceTable();
+    assert(D.size() == 100);
+    int sum = 0;
     for (int i = 0; i < P->getNum(); ++i) {
-        sum += std::accumulate(D2[i].begin(), D2[i].end(), 0);
+        sum += std::accumulate(D[i].begin(), D[i].end(), 0);
     }
     assert(sum < 735000000);
+    assert(&baseline->getDistanceTable() == &D);        // no copy
 
     baseline->solve();
     assert(baseline->getPreCompTime() != 0);
@@ -171,26 +416,26 @@ void test_solver() {
     assert(baseline->getLowerBoundMakespan() != 0);
     assert(baseline->succeed() == false);
     debug("Baseline solver ... [OK]", t_start);
-    delete baseline; delete P; delete G; delete MT;
+    delete baseline; delete P; delete G;
 }
 
 void test_pibt() {
     auto t_start = Time::now();
 
     Grid* G = new Grid("assets/warehouse", true);
-    std::mt19937* MT = new std::mt19937(42);
+    uint64_t seed = 42;
     int max_timestep = 10000;
     int max_comp_time = 1000;
-    MAPF_Instance* P = new MAPF_Instance(G, MT, max_timestep, max_comp_time);
+    MAPF_Instance* P = new MAPF_Instance(G, seed, max_timestep, max_comp_time);
     P->make(200);
-    MAPF_Solver* mapf = new PIBT(P);
+    MAPF_Solver* mapf = new PIBT<Oriented>(P);
 
     assert(mapf->getSolverName() == "PIBT");
     assert(mapf->getMaxTimestep() == 10000);
     assert(mapf->getPreCompTime() == 0);
     assert(mapf->getCompTime() == 0);
     assert(mapf->getP() == P);
-    assert(mapf->getDistanceTable().size() == 200);
+    assert(mapf->getDistanceTable().size() == 0);
     assert(mapf->getSolution().size() == 0);
     assert(mapf->succeed() == false);
 
@@ -204,8 +449,47 @@ void test_pibt() {
     assert(mapf->getSolution().getMakespan() != 0);
     assert(mapf->getLowerBoundMakespan() <= mapf->getSolution().getMakespan());
     assert(mapf->getLowerBoundSOC() != 0);
+
+    // same instance streamed to a file; a generous time limit keeps slow builds deterministic
+    MAPF_Instance* Q = new MAPF_Instance(G, seed, max_timestep, 10 * max_comp_time);
+    Q->make(P->getConfigStart(), P->getConfigGoal(), P->getNum());
+    MAPF_Solver* other = new PIBT<Oriented>(Q);
+    other->streamSolution("test.bplan");
+    other->solve();
+    assert(other->succeed() == true);
+    assert(other->getSolution().getMakespan() == mapf->getSolution().getMakespan());
+    for (int i = 0; i < P->getNum(); ++i) {
+        assert(other->getSolution().getPath(i) == mapf->getSolution().getPath(i));
+    }
+    {
+        PlanReader streamed("test.bplan");
+        assert(streamed.getMakespan() == mapf->getSolution().getMakespan());
+        for (int i = 0; i < P->getNum(); ++i) {
+            assert(streamed.getPath(i) == mapf->getSolution().getPath(i));
+        }
+    }
+    std::filesystem::remove("test.bplan");
+
+    // independent instances and solvers on separate threads, sharing the graph
+    std::vector<MAPF_Instance*> instances;
+    std::vector<MAPF_Solver*> solvers;
+    for (int k = 0; k < 4; ++k) {
+        instances.push_back(new MAPF_Instance(G, seed, max_timestep, 10 * max_comp_time));
+        instances[k]->make(P->getConfigStart(), P->getConfigGoal(), P->getNum());
+        solvers.push_back(new PIBT<Oriented>(instances[k]));
+    }
+    std::vector<std::thread> threads;
+    for (auto solver : solvers) threads.emplace_back([solver] {solver->solve();});
+    for (auto& thread : threads) thread.join();
+    for (int k = 0; k < 4; ++k) {
+        assert(solvers[k]->succeed() == true);
+        for (int i = 0; i < P->getNum(); ++i) {
+            assert(solvers[k]->getSolution().getPath(i) == mapf->getSolution().getPath(i));
+        }
+        delete solvers[k]; delete instances[k];
+    }
     debug("PIBT solver (random instance) ... [OK]", t_start);
-    delete mapf;
+    delete other; delete Q; delete mapf;
 
     // scenario 1
     t_start = Time::now();
@@ -218,11 +502,11 @@ void test_pibt() {
         {G->getNode(17, 18), 0},
     };
     P->make(config_s, config_g, 2);
-    mapf = new PIBT(P);
+    mapf = new PIBT<Oriented>(P);
     assert(mapf->getPreCompTime() == 0);
     assert(mapf->getCompTime() == 0);
     assert(mapf->getP() == P);
-    assert(mapf->getDistanceTable().size() == 2);
+    assert(mapf->getDistanceTable().size() == 0);
     assert(mapf->getSolution().size() == 0);
     assert(mapf->succeed() == false);
 
@@ -249,11 +533,11 @@ void test_pibt() {
         {G->getNode(17, 18), 0},
     };
     P->make(config_s, config_g, 3);
-    mapf = new PIBT(P);
+    mapf = new PIBT<Oriented>(P);
     assert(mapf->getPreCompTime() == 0);
     assert(mapf->getCompTime() == 0);
     assert(mapf->getP() == P);
-    assert(mapf->getDistanceTable().size() == 3);
+    assert(mapf->getDistanceTable().size() == 0);
     assert(mapf->getSolution().size() == 0);
     assert(mapf->succeed() == false);
 
@@ -282,11 +566,11 @@ void test_pibt() {
         {G->getNode(17, 15), 2},
     };
     P->make(config_s, config_g, 4);
-    mapf = new PIBT(P);
+    mapf = new PIBT<Oriented>(P);
     assert(mapf->getPreCompTime() == 0);
     assert(mapf->getCompTime() == 0);
     assert(mapf->getP() == P);
-    assert(mapf->getDistanceTable().size() == 4);
+    assert(mapf->getDistanceTable().size() == 0);
     assert(mapf->getSolution().size() == 0);
     assert(mapf->succeed() == false);
 
@@ -298,7 +582,849 @@ void test_pibt() {
     assert(mapf->getSolution().validate(P) == true);
     mapf->getSolution().save("scenario3.plan");
     debug("PIBT solver (Scenario 3) ... [OK]", t_start);
-    delete mapf; delete P; delete G; delete MT;
+    delete mapf;
+
+    // scenario 4 (agents rotating around a 2x2 block)
+    t_start = Time::now();
+    config_s = {
+        {G->getNode(0, 0), 3},
+        {G->getNode(1, 0), 0},
+        {G->getNode(1, 1), 1},
+        {G->getNode(0, 1), 2},
+    };
+    config_g = {
+        {G->getNode(1, 0), 3},
+        {G->getNode(1, 1), 0},
+        {G->getNode(0, 1), 1},
+        {G->getNode(0, 0), 2},
+    };
+    P->make(config_s, config_g, 4);
+    mapf = new PIBT<Oriented>(P);
+    mapf->solve();
+    assert(mapf->succeed() == true);
+    assert(mapf->getSolution().getMakespan() == 1);
+    assert(mapf->getSolution().validate(P) == true);
+    debug("PIBT solver (Scenario 4) ... [OK]", t_start);
+    delete mapf;
+
+    // scenario 5 (early termination without progress)
+    t_start = Time::now();
+    config_s = {{G->getNode(0, 0), 1}};
+    config_g = {{G->getNode(5, 0), 3}};
+    P->make(config_s, config_g, 1);
+    PIBT<Oriented>* pibt = new PIBT<Oriented>(P);
+    pibt->setStallWindow(2);
+    pibt->setMaxRecoveries(0);
+    pibt->solve();
+    assert(pibt->succeed() == false);
+    assert(pibt->getSolution().getMakespan() == 2);
+    delete pibt;
+
+    pibt = new PIBT<Oriented>(P);
+    pibt->setStallWindow(3);
+    pibt->setMaxRecoveries(0);
+    pibt->solve();
+    assert(pibt->succeed() == true);
+    assert(pibt->getSolution().getMakespan() == 7);
+    assert(pibt->getSolution().validate(P) == true);
+    debug("PIBT solver (Scenario 5) ... [OK]", t_start);
+    delete pibt;
+
+    // scenario 6 (omnidirectional agents)
+    t_start = Time::now();
+    config_s = {
+        {G->getNode(9, 17)},
+        {G->getNode(25, 17)},
+        {G->getNode(17, 9)},
+    };
+    config_g = {
+        {G->getNode(17, 18)},
+        {G->getNode(17, 18)},
+        {G->getNode(17, 18)},
+    };
+    P->make(config_s, config_g, 3);
+    assert(P->getMotionModel() == MotionModel::OMNIDIRECTIONAL);
+    mapf = new PIBT<Omnidirectional>(P);
+    mapf->solve();
+    assert(mapf->succeed() == true);
+    assert(mapf->getSolution().validate(P) == true);
+    assert(mapf->getSolution().getPath(0).back() == State(G->getNode(17, 18)));
+    debug("PIBT solver (Scenario 6) ... [OK]", t_start);
+    delete mapf;
+
+    // stepping reproduces a full solve
+    t_start = Time::now();
+    P->make(50);
+    mapf = new PIBT<Oriented>(P);
+    mapf->solve();
+    auto online = new PIBT<Oriented>(P);
+    online->init();
+    assert(online->isInitialized() && online->getTimestep() == 0);
+    while (!online->succeed() && online->getTimestep() < 1000) online->step();
+    assert(online->succeed() == true);
+    assert(online->getMaxStepTime() >= online->getLastStepTime());
+    assert(online->getOverruns() == 0);       // no budget
+    for (int i = 0; i < P->getNum(); ++i) {
+        assert(online->getSolution().getPath(i) == mapf->getSolution().getPath(i));
+    }
+    // init after a solve, or a second init, starts from an empty plan
+    online->solve();
+    online->init();
+    assert(online->succeed() == false && online->getSolution().getMakespan() == 0);
+    online->step();
+    online->init();
+    assert(online->getSolution().getMakespan() == 0);
+    while (!online->succeed() && online->getTimestep() < 1000) online->step();
+    assert(online->getSolution().validate(P) == true);
+    for (int i = 0; i < P->getNum(); ++i) {
+        assert(online->getSolution().getPath(i) == mapf->getSolution().getPath(i));
+    }
+    delete online; delete mapf;
+
+    // observed states override planned ones
+    online = new PIBT<Oriented>(P);
+    online->init();
+    Config planned = online->step();
+    int k = 0;
+    while (planned[k] == P->getConfigStart()[k] || std::count(planned.begin(), planned.end(), P->getConfigStart()[k]) > 0) ++k;
+    Config observed(P->getNum());       // empty: as planned
+    observed[k] = P->getConfigStart()[k];
+    Config next = online->step(observed);
+    assert(Oriented::checkTransition(P->getStart(k), G->getState(next[k])) == nullptr);
+
+    // steps over the latency budget are counted until the next init
+    online->setStepBudget(1);
+    int over = 0;
+    for (int s = 0; s < 10; ++s) {
+        online->step();
+        if (online->getLastStepTime() > 1) ++over;
+    }
+    assert(online->getOverruns() == over);
+    online->setStepBudget(INT_MAX);
+    online->init();
+    online->step();
+    assert(online->getOverruns() == 0);
+    delete online;
+
+    // new goal before arrival
+    config_s = {{G->getNode(9, 17), 3}, {G->getNode(25, 17), 1}};
+    config_g = {{G->getNode(17, 18), 0}, {G->getNode(0, 0), 2}};
+    P->make(config_s, config_g, 2);
+    online = new PIBT<Oriented>(P);
+    online->init();
+    online->step();
+    online->resetGoal(0, State(G->getNode(34, 0), 1));
+    bool raised = false;
+    try {
+        online->resetGoal(1, State(G->getNode(0, 0)));      // oriented agents need a goal heading
+    } catch (const MAPFError&) {
+        raised = true;
+    }
+    assert(raised);
+    while (!online->succeed() && online->getTimestep() < 1000) online->step();
+    assert(online->succeed() == true);
+    assert(online->getSolution().getPath(0).back() == State(G->getNode(34, 0), 1));
+    assert(online->getSolution().getPath(1).back() == State(G->getNode(0, 0), 2));
+    debug("PIBT solver (Stepping) ... [OK]", t_start);
+    delete online;
+
+    // lifelong, goals from a shared queue
+    t_start = Time::now();
+    MAPF_Instance* L = new MAPF_Instance(G, seed, 500, 10000);
+    L->make(30);
+    GoalQueue queue;
+    RNG rng(seed);
+    for (int k = 0; k < 1000; ++k) {
+        Node* v = nullptr;
+        while (v == nullptr) v = G->getNode(getRandomInt(0, G->size() - 1, rng));
+        queue.push(State(v, getRandomInt(0, 3, rng)));
+    }
+    auto lifelong = new PIBT<Oriented>(L);
+    lifelong->setGoalProvider(queue.provider());
+    assert(lifelong->isLifelong() == true);
+    lifelong->solve();
+    assert(lifelong->succeed() == true);
+    assert(lifelong->getSolution().getMakespan() == 500);
+    assert(lifelong->getTasksCompleted() == 1000 - (int)queue.size() && lifelong->getTasksCompleted() > 30);
+    assert(std::abs(lifelong->getThroughput() - 2.f * lifelong->getTasksCompleted()) < 1e-3);
+    assert(lifelong->getDistanceCacheSize() == 256);
+    for (auto& c : lifelong->getSolution().findConflicts(L)) assert(c.type == ConflictType::GOAL);
+    delete lifelong;
+
+    // agents out of tasks stay on the map and pick up goals pushed later
+    GoalQueue later;
+    auto push = [&](int n) {
+        for (int k = 0; k < n; ++k) {
+            Node* v = nullptr;
+            while (v == nullptr) v = G->getNode(getRandomInt(0, G->size() - 1, rng));
+            later.push(State(v, getRandomInt(0, 3, rng)));
+        }
+    };
+    push(10);
+    lifelong = new PIBT<Oriented>(L);
+    lifelong->setGoalProvider(later.provider());
+    lifelong->init();
+    while (lifelong->getTasksCompleted() < 40 && lifelong->getTimestep() < 500) lifelong->step();
+    assert(lifelong->getTasksCompleted() == 40);
+    for (int k = 0; k < 20; ++k) lifelong->step();
+    Config waiting = lifelong->getConfig();
+    assert(std::none_of(waiting.begin(), waiting.end(), [](const PackedState& s) {return s.empty();}));
+    assert(lifelong->getTasksCompleted() == 40 && lifelong->succeed() == false);
+    push(5);
+    while (lifelong->getTasksCompleted() < 45 && lifelong->getTimestep() < 500) lifelong->step();
+    assert(lifelong->getTasksCompleted() == 45 && later.size() == 0);
+    for (auto& c : lifelong->getSolution().findConflicts(L)) assert(c.type == ConflictType::GOAL);
+    debug("PIBT solver (Lifelong) ... [OK]", t_start);
+
+    // rolling horizon commits the same steps as a full run
+    t_start = Time::now();
+    P->make(80);
+    mapf = new PIBT<Oriented>(P);
+    mapf->solve();
+    auto windowed = new PIBT<Oriented>(P);
+    windowed->setRecording(false);
+    windowed->init();
+    Plan executed(G);
+    executed.add(windowed->getConfig());
+    while (!windowed->succeed() && windowed->getTimestep() < 1000) {
+        if (windowed->getTimestep() == 9) windowed->refreshDistances();       // weights unchanged
+        Plan window = windowed->planWindow(10, 3);
+        assert(window.getMakespan() <= 10);
+        int steps = std::min(3, window.getMakespan());
+        for (int h = 1; h <= steps; ++h) {
+            Config config(P->getNum());
+            for (int i = 0; i < P->getNum(); ++i) config[i] = window.getReader(i, h).get();
+            executed.add(config);
+        }
+    }
+    assert(windowed->succeed() == true);
+    assert(windowed->getSolution().empty() == true);
+    assert(executed.getMakespan() == mapf->getSolution().getMakespan());
+    for (int i = 0; i < P->getNum(); ++i) {
+        assert(executed.getPath(i) == mapf->getSolution().getPath(i));
+    }
+    delete windowed; delete mapf;
+    debug("PIBT solver (Rolling horizon) ... [OK]", t_start);
+
+    // warm start keeps the plan so far and only computes distances of changed goals
+    t_start = Time::now();
+    P->make(60);
+    auto warm = new PIBT<Oriented>(P);
+    warm->solve();
+    assert(warm->succeed() == true);
+    Plan before = warm->getSolution();
+    for (int i = 0; i < 3; ++i) P->setGoal(i, P->getStart(i));
+    warm->clearDistanceCache();
+    warm->replan();
+    assert(warm->succeed() == true);
+    assert(warm->getDistanceCacheSize() == 3);
+    assert(warm->getSolution().validate(P) == true);
+    assert(warm->getSolution().getMakespan() > before.getMakespan());
+    for (int i = 0; i < P->getNum(); ++i) {
+        Path prefix = before.getPath(i);
+        Path path = warm->getSolution().getPath(i);
+        assert(std::equal(prefix.begin(), prefix.end(), path.begin()));
+        if (i < 3) assert(G->getState(path.back()) == P->getStart(i));
+    }
+    warm->replan();      // nothing changed
+    assert(warm->succeed() == true);
+    assert(warm->getSolution().getMakespan() > before.getMakespan());
+    warm->setDistanceCacheCapacity(1);
+    assert(warm->getDistanceCacheSize() == 1);
+
+    // least recently used rows are evicted first
+    Node* u1 = P->getStart(0).node;
+    Node* u2 = P->getStart(1).node;
+    Node* u3 = P->getStart(2).node;
+    warm->clearDistanceCache();
+    warm->setDistanceCacheCapacity(2);
+    warm->updateDistance(0, u1);
+    warm->updateDistance(0, u2);
+    warm->updateDistance(0, u1);
+    warm->updateDistance(0, u3);
+    assert(warm->getDistanceCacheSize() == 2);
+    assert(warm->isDistanceCached(u1) && !warm->isDistanceCached(u2) && warm->isDistanceCached(u3));
+    delete warm;
+
+    // rows cached before a rebuild do not outlive the weights they were computed with
+    auto weighted = new PIBT<Oriented>(P);
+    weighted->init();
+    Node* v = P->getStart(0).node;
+    weighted->updateDistance(0, v);
+    assert(weighted->getDistanceCacheSize() == 1);
+    std::vector<int> row = weighted->getDistanceTable()[0];
+    std::vector<float> original = G->getWeights();
+    G->setWeights(std::vector<float>(original.size(), MAX_WEIGHT));
+    weighted->init();
+    assert(weighted->getDistanceCacheSize() == 0);
+    weighted->updateDistance(0, v);
+    assert(weighted->getDistanceTable()[0] != row);
+    for (auto d : weighted->getDistanceTable()[0]) assert(d == 0 || d == P->getMaxTimestep());
+    G->setWeights(original);
+    delete weighted;
+    debug("PIBT solver (Warm start) ... [OK]", t_start);
+
+    // parallel steps plan tiles concurrently, independent of the number of workers
+    t_start = Time::now();
+    P->make(300);
+    auto serial = new PIBT<Oriented>(P);
+    serial->solve();
+    Plan reference;
+    for (int th : {2, 4}) {
+        auto parallel = new PIBT<Oriented>(P);
+        parallel->setNumThreads(th);
+        parallel->setTileSize(8);
+        assert(parallel->getNumThreads() == th);
+        parallel->solve();
+        assert(parallel->succeed() == true);
+        assert(parallel->getSolution().validate(P) == true);
+        assert(parallel->getSolution().getSOC() < 2 * serial->getSolution().getSOC());
+        if (reference.empty()) reference = parallel->getSolution();
+        for (int i = 0; i < P->getNum(); ++i) {
+            assert(parallel->getSolution().getPath(i) == reference.getPath(i));
+        }
+        delete parallel;
+    }
+
+    // workers persist across steps and plan the same steps as a full solve
+    for (int th : {2, 4}) {
+        auto online = new PIBT<Oriented>(P);
+        online->setNumThreads(th);
+        online->setTileSize(8);
+        online->init();
+        while (!online->succeed() && online->getTimestep() < 1000) online->step();
+        assert(online->succeed() == true);
+        for (int i = 0; i < P->getNum(); ++i) assert(online->getSolution().getPath(i) == reference.getPath(i));
+        delete online;
+    }
+    delete serial;
+    debug("PIBT solver (Parallel) ... [OK]", t_start);
+    delete lifelong; delete L; delete P; delete G;
+}
+
+void test_lacam() {
+    auto t_start = Time::now();
+
+    Grid* G = new Grid("assets/warehouse", true);
+    MAPF_Instance* P = new MAPF_Instance(G, 42, 10000, 5000);
+    P->make(500);
+    Parameters params;
+    params.solver = "LACAM";
+    MAPF_Solver* mapf = make_solver(P, params);
+    assert(mapf->getSolverName() == "LaCAM");
+    mapf->solve();
+    assert(mapf->succeed() == true);
+    assert(mapf->getSolution().validate(P) == true);
+    assert(dynamic_cast<LaCAM<Oriented>*>(mapf)->getNumExplored() > mapf->getSolution().getMakespan());
+
+    // same seed, same plan
+    MAPF_Solver* again = make_solver(P, params);
+    again->solve();
+    for (int i = 0; i < P->getNum(); ++i) assert(again->getSolution().getPath(i) == mapf->getSolution().getPath(i));
+    delete again; delete mapf;
+
+    mapf = solve_omnidirectional(P, params);
+    assert(mapf->getSolution().validate(P) == true);
+    delete mapf;
+    debug("LaCAM solver (random instance) ... [OK]", t_start);
+
+    // solves the instance PIBT terminates early on, see PIBT scenario 5
+    t_start = Time::now();
+    Config config_s = {{G->getNode(0, 0), 1}};
+    Config config_g = {{G->getNode(5, 0), 3}};
+    P->make(config_s, config_g, 1);
+    PIBT<Oriented>* pibt = new PIBT<Oriented>(P);
+    pibt->setStallWindow(2);
+    pibt->setMaxRecoveries(0);
+    pibt->solve();
+    assert(pibt->succeed() == false);
+    auto lacam = new LaCAM<Oriented>(P);
+    lacam->solve();
+    assert(lacam->succeed() == true);
+    assert(lacam->getSolution().getMakespan() == 7);
+    assert(lacam->getSolution().validate(P) == true);
+    delete lacam; delete pibt;
+
+    // exhausts the search space when no solution exists within the horizon
+    config_s = {{G->getNode(0, 0), 0}};
+    config_g = {{G->getNode(20, 8), 0}};
+    P->make(config_s, config_g, 1);
+    P->setMaxTimestep(5);
+    lacam = new LaCAM<Oriented>(P);
+    lacam->solve();
+    assert(lacam->succeed() == false);
+    assert(lacam->getNumExplored() > 1);
+    debug("LaCAM solver (Scenarios) ... [OK]", t_start);
+    delete lacam; delete P; delete G;
+}
+
+void test_pp() {
+    auto t_start = Time::now();
+
+    Grid* G = new Grid("assets/warehouse", true);
+    ReservationTable table(G);
+    Path a = {{G->getNode(0, 0), -1}, {G->getNode(1, 0), -1}, {G->getNode(2, 0), -1}};
+    table.reserve(0, a);
+    assert(table.size() == 3);
+    assert(table.getHorizon() == 3);
+    assert(table.occupant(1, G->getNode(1, 0)->id) == 0);
+    assert(table.occupant(0, G->getNode(1, 0)->id) == -1);
+    assert(table.canMove(0, G->getNode(1, 0), G->getNode(0, 0)) == false);       // swap
+    assert(table.canMove(0, G->getNode(0, 1), G->getNode(1, 0)) == false);       // vertex
+    assert(table.canMove(1, G->getNode(1, 1), G->getNode(1, 0)) == true);        // follows
+    table.hold(1, G->getNode(5, 5));
+    assert(table.isFree(0, G->getNode(5, 5)) == true);
+    table.setHoldWindow(2);
+    assert(table.occupant(2, G->getNode(5, 5)->id) == 1);
+    assert(table.isFree(3, G->getNode(5, 5)) == true);
+    table.release(0, a);
+    assert(table.size() == 0);
+
+    // shortest paths on an empty table
+    MAPF_Instance* P = new MAPF_Instance(G, 42, 10000, 10000);
+    P->make(200);
+    table.clear();
+    MAPF_Solver* pibt = new PIBT<Oriented>(P);
+    pibt->solve();
+    SpaceTimeAStar<Oriented> search(G, table);
+    Path path;
+    assert(search.findPath(P->getConfigStart()[0], P->getConfigGoal()[0],
+        [&](Node* v) {return pibt->pathDist(0, v);}, 10000, path) == true);
+    assert((int)path.size() - 1 >= pibt->pathDist(0));
+    assert(path.front() == P->getConfigStart()[0] && path.back() == P->getConfigGoal()[0]);
+    debug("Reservation table ... [OK]", t_start);
+
+    t_start = Time::now();
+    Parameters params;
+    params.solver = "PP";
+    MAPF_Solver* mapf = make_solver(P, params);
+    assert(mapf->getSolverName() == "PP");
+    mapf->solve();
+    assert(mapf->succeed() == true);
+    assert(mapf->getSolution().validate(P) == true);
+    assert(mapf->getSolution().getSOC() < pibt->getSolution().getSOC());
+    assert(dynamic_cast<PrioritizedPlanning<Oriented>*>(mapf)->getNumRestarts() == 0);
+    delete mapf; delete pibt;
+
+    mapf = solve_omnidirectional(P, params);
+    assert(mapf->getSolution().validate(P) == true);
+    delete mapf;
+    debug("Prioritized planning (random instance) ... [OK]", t_start);
+
+    // restarts with the failed agent first
+    t_start = Time::now();
+    delete P;
+    P = new MAPF_Instance(G, 8, 10000, 10000);
+    P->make(170);
+    auto pp = new PrioritizedPlanning<Oriented>(P);
+    pp->setMaxRestarts(0);
+    pp->solve();
+    assert(pp->succeed() == false);
+    delete pp;
+    pp = new PrioritizedPlanning<Oriented>(P);
+    pp->solve();
+    assert(pp->succeed() == true);
+    assert(pp->getNumRestarts() == 1);
+    assert(pp->getSolution().validate(P) == true);
+    debug("Prioritized planning (Restarts) ... [OK]", t_start);
+    delete pp; delete P;
+
+    // weighted rows count the steps of the cheapest path; paths still take the fewest steps
+    t_start = Time::now();
+    const std::vector<float> original = G->getWeights();
+    std::vector<float> uniform = original, skewed = original;
+    RNG rng(3);
+    for (size_t k = 0; k < original.size(); ++k) {
+        if (original[k] >= MAX_WEIGHT) continue;
+        uniform[k] = 1.f;
+        skewed[k] = getRandomFloat(1.f, 20.f, rng);
+    }
+    for (uint64_t s = 0; s < 20; ++s) {
+        P = new MAPF_Instance(G, s, 10000, 10000);
+        P->make(1);
+        G->setWeights(uniform);
+        MAPF_Solver* shortest = solve_omnidirectional(P, params);
+        G->setWeights(skewed);
+        mapf = make_solver(P, params);
+        mapf->solve();
+        assert(mapf->succeed() == true);
+        assert(mapf->getSolution().getMakespan() == shortest->getSolution().getMakespan());
+        delete mapf; delete shortest; delete P;
+    }
+    G->setWeights(original);
+    debug("Prioritized planning (Weighted map) ... [OK]", t_start);
+    delete G;
+}
+
+void test_tswap() {
+    auto t_start = Time::now();
+
+    Grid* G = new Grid("assets/warehouse", true);
+    MAPF_Instance* P = new MAPF_Instance(G, 1, 10000, 10000);
+    P->make(300);
+    Parameters params;
+    params.solver = "TSWAP";
+    MAPF_Solver* mapf = make_solver(P, params);
+    assert(mapf->getSolverName() == "TSWAP");
+    mapf->solve();
+    assert(mapf->succeed() == true);
+    auto tswap = dynamic_cast<TSWAP<Oriented>*>(mapf);
+    std::vector<int> assignment = tswap->getAssignment();
+    std::sort(assignment.begin(), assignment.end());
+    for (int k = 0; k < P->getNum(); ++k) assert(assignment[k] == k);      // every goal served once
+    assert(tswap->getNumSwaps() > 0);
+
+    // labeled instance of the final assignment
+    PIBT<Oriented>* pibt = new PIBT<Oriented>(P);
+    pibt->solve();
+    MAPF_Instance* Q = new MAPF_Instance(G, 1, 10000, 10000);
+    Q->make(P->getConfigStart(), tswap->getAssignedGoals(), P->getNum());
+    assert(mapf->getSolution().validate(Q) == true);
+    assert(mapf->getSolution().getMakespan() < pibt->getSolution().getMakespan());
+    assert(mapf->getSolution().getSOC() < pibt->getSolution().getSOC());
+    delete mapf; delete pibt;
+
+    mapf = solve_omnidirectional(P, params);
+    auto omni = dynamic_cast<TSWAP<Omnidirectional>*>(mapf);
+    Q->make(P->getConfigStart(), omni->getAssignedGoals(), P->getNum());
+    assert(omni->getSolution().validate(Q) == true);
+    debug("TSWAP solver ... [OK]", t_start);
+    delete mapf; delete Q; delete P; delete G;
+}
+
+void test_lns() {
+    auto t_start = Time::now();
+
+    Grid* G = new Grid("assets/warehouse", true);
+    MAPF_Instance* P = new MAPF_Instance(G, 42, 10000, 1000);
+    P->make(100);
+    Parameters params;
+    params.solver = "LNS";
+    MAPF_Solver* mapf = make_solver(P, params);
+    assert(mapf->getSolverName() == "LNS");
+    mapf->solve();
+    assert(mapf->succeed() == true);
+    assert(mapf->getSolution().validate(P) == true);
+
+    // refines the solution of the initial solver, improvements only
+    auto lns = dynamic_cast<LNS<Oriented>*>(mapf);
+    const auto& timeline = lns->getTimeline();
+    assert(lns->getInitialSolver()->getSolverName() == "PIBT");
+    assert(timeline.front().second == lns->getInitialSolver()->getSolution().getSOC());
+    for (size_t k = 1; k < timeline.size(); ++k) {
+        assert(timeline[k].second < timeline[k - 1].second);
+        assert(timeline[k].first >= timeline[k - 1].first);
+    }
+    assert(timeline.back().second == mapf->getSolution().getSOC());
+    assert(mapf->getSolution().getSOC() < lns->getInitialSolver()->getSolution().getSOC());
+    assert(mapf->getSolution().getSOC() >= mapf->getLowerBoundSOC());
+    assert(lns->getLowerBound() == mapf->getLowerBoundSOC());
+    assert(lns->getIterations() > 0);
+    delete mapf;
+
+    // on skewed weights the distance rows overestimate, the bound must not
+    const std::vector<float> original = G->getWeights();
+    std::vector<float> skewed = original;
+    RNG rng(3);
+    for (auto& w : skewed) {
+        if (w < MAX_WEIGHT) w = getRandomFloat(1.f, 20.f, rng);
+    }
+    G->setWeights(skewed);
+    lns = new LNS<Oriented>(P);
+    lns->solve();
+    assert(lns->succeed() == true);
+    assert(lns->getLowerBound() < lns->getLowerBoundSOC());
+    assert(lns->getSolution().getSOC() >= lns->getLowerBound());
+    G->setWeights(original);
+    delete lns;
+
+    // any solver provides the initial solution
+    params.lns_initial = "LACAM";
+    mapf = make_solver(P, params);
+    mapf->solve();
+    assert(mapf->succeed() == true);
+    assert(mapf->getSolution().validate(P) == true);
+    assert(dynamic_cast<LNS<Oriented>*>(mapf)->getInitialSolver()->getSolverName() == "LaCAM");
+    delete mapf;
+    debug("LNS solver ... [OK]", t_start);
+    delete P; delete G;
+}
+
+void test_adg() {
+    auto t_start = Time::now();
+
+    Grid* G = new Grid("assets/warehouse", true);
+    MAPF_Instance* P = new MAPF_Instance(G, 1, 10000, 10000);
+    P->make(100);
+    PIBT<Oriented>* pibt = new PIBT<Oriented>(P);
+    pibt->solve();
+    ActionDependencyGraph adg(pibt->getSolution());
+    assert(adg.size() == P->getNum());
+    assert(adg.getNumActions() > 0 && adg.getNumEdges() > 0);
+    for (int i = 0; i < P->getNum(); ++i) assert(adg.getState(i) == P->getConfigStart()[i]);
+    try {
+        adg.reportCompletion(0);
+        assert(false);
+    } catch (const MAPFError&) {}
+    assert(adg.getMotionModel() == MotionModel::ORIENTED);
+    try {
+        adg.replan<Omnidirectional>(10000);     // headings of the plan decide the motion model
+        assert(false);
+    } catch (const MAPFError&) {}
+
+    // robots run late at random, agent 0 stalls at its first action
+    const int N = P->getNum();
+    Plan executed(G);
+    executed.add(P->getConfigStart());
+    std::vector<int> busy(N, 0);
+    std::vector<PackedState> target(N);
+    RNG rng(1, Stream::SEARCH);
+    int delayed = 0, blocked = 0;
+    for (int t = 0; !adg.finished() && t < 1000; ++t) {
+        std::unordered_map<int, int> rotation_delay;        // rotations move in lockstep
+        for (auto& c : adg.release()) {
+            int d = (getRandomFloat(0, 1, rng) < 0.05f) ? getRandomInt(1, 3, rng) : 0;
+            if (c.agent == 0 && c.index == 0) d = 40;
+            if (c.rotation != -1) d = rotation_delay.emplace(c.rotation, d).first->second;
+            busy[c.agent] = 1 + d;
+            target[c.agent] = c.to;
+            if (d > 0) {
+                adg.reportDelay(c.agent, d);
+                ++delayed;
+            }
+        }
+        Config config(N);
+        for (int i = 0; i < N; ++i) {
+            config[i] = adg.getState(i);
+            if (busy[i] > 0 && --busy[i] == 0) {
+                adg.reportCompletion(i);
+                config[i] = target[i];
+            }
+        }
+        executed.add(config);
+        if (adg.isBlocked()) {
+            ++blocked;
+            assert(adg.replan<Oriented>(10000) == true);
+            assert(adg.isBlocked() == false);
+        }
+    }
+    assert(adg.finished() == true);
+    assert(blocked > 0 && adg.getNumReplans() == blocked);
+    assert(adg.getNumReplans() < delayed);      // most delays are absorbed by the dependencies
+    assert(executed.validate(P) == true);
+    assert(executed.getMakespan() > pibt->getSolution().getMakespan());
+    debug("Action dependency graph ... [OK]", t_start);
+    delete pibt; delete P; delete G;
+}
+
+void test_traffic() {
+    auto t_start = Time::now();
+
+    Grid* G = new Grid("assets/warehouse", true);
+    MAPF_Instance* P = new MAPF_Instance(G, 42, 10000, 10000);
+    P->make(100);
+    PIBT<Oriented>* pibt = new PIBT<Oriented>(P);
+    pibt->solve();
+    TrafficStats stats(G);
+    stats.record(pibt->getSolution());
+    int64_t visits = 0, moves = 0, waits = 0;
+    for (int k = 0; k < G->size(); ++k) {
+        if (!G->existNode(k)) continue;
+        Node* v = G->getNode(k);
+        visits += stats.getVisits(v);
+        waits += stats.getWaits(v);
+        for (int ch = 0; ch < 4; ++ch) {
+            moves += stats.getFlow(v, ch);
+            if (stats.getFlow(v, ch) > 0) assert(G->getWeight(v, ch) < MAX_WEIGHT);
+        }
+    }
+    assert(visits == pibt->getSolution().getSOC() + P->getNum());
+    assert(moves + waits == stats.getNumSteps() && stats.getNumSteps() == pibt->getSolution().getSOC());
+    assert(stats.getWaitRatio() > 0.f && stats.getNumPlans() == 1);
+    Node* u = G->getNode(1, 1);
+    assert(stats.getContraFlow(u, 3) == stats.getFlow(G->getNode(2, 1), 1));
+    delete pibt;
+    debug("Traffic statistics ... [OK]", t_start);
+
+    // guidance learned on a task sequence, exported and loaded again
+    t_start = Time::now();
+    RNG rng(7);
+    std::vector<State> tasks;
+    for (int k = 0; k < 3000; ++k) {
+        Node* v = nullptr;
+        while (v == nullptr) v = G->getNode(getRandomInt(0, G->size() - 1, rng));
+        tasks.push_back(State(v, getRandomInt(0, 3, rng)));
+    }
+    const std::vector<float> uniform = G->getWeights();
+    GuidanceOptimizer<Oriented> guidance(G, 60, tasks, 300, 1);
+    float throughput = guidance.optimize(4);
+    assert(guidance.getHistory().size() == 5);
+    assert(throughput == guidance.getBestThroughput() && throughput > guidance.getHistory()[0]);
+    assert(G->getWeights() != uniform);
+    for (size_t k = 0; k < uniform.size(); ++k) {
+        if (uniform[k] >= MAX_WEIGHT) assert(G->getWeights()[k] >= MAX_WEIGHT);
+        else assert(uniform[k] <= G->getWeights()[k] && G->getWeights()[k] <= guidance.getMaxWeight());
+    }
+    assert(guidance.evaluate() == throughput);      // deterministic
+    std::filesystem::copy_file("assets/warehouse.map", "guided.map", std::filesystem::copy_options::overwrite_existing);
+    G->saveWeights("guided.weights");
+    Grid* H = new Grid("guided", true);
+    for (size_t k = 0; k < uniform.size(); ++k) {
+        assert(std::abs(H->getWeights()[k] - G->getWeights()[k]) < 1e-3f || H->getWeights()[k] == G->getWeights()[k]);
+    }
+    std::filesystem::remove("guided.map");
+    std::filesystem::remove("guided.weights");
+
+    // tasks carry headings only for oriented agents
+    G->setWeights(uniform);
+    std::vector<State> headless;
+    for (auto& g : tasks) headless.push_back(State(g.node));
+    GuidanceOptimizer<Omnidirectional> omni(G, 60, headless, 300, 1);
+    assert(omni.evaluate() > 0.f);
+    assert(omni.getStats().getNumSteps() > 0);
+    bool raised = false;
+    try {
+        GuidanceOptimizer<Oriented>(G, 60, headless, 300, 1);
+    } catch (const MAPFError&) {
+        raised = true;
+    }
+    assert(raised);
+    debug("Guidance optimization ... [OK]", t_start);
+    delete H; delete P; delete G;
+}
+
+void test_batch() {
+    auto t_start = Time::now();
+
+    Grid* G = new Grid("assets/warehouse", true);
+    Parameters params;
+    params.solver = "PIBT";
+    InstanceSpecs specs;
+    for (int k = 0; k < 6; ++k) {
+        InstanceSpec spec;
+        spec.seed = k;
+        spec.num_agents = 20 * (k + 1);
+        spec.keep_plan = (k == 2);
+        specs.push_back(spec);
+    }
+    InstanceSpec invalid;
+    invalid.starts = {{G->getNode(0, 0), 0}, {G->getNode(1, 0), 0}};
+    invalid.goals = {{G->getNode(2, 0), 0}};
+    specs.push_back(invalid);
+
+    BatchSolver batch(G, params, 3);
+    batch.solve(specs);
+    const BatchResults& results = batch.getResults();
+    assert(results.size() == 7);
+    for (int k = 0; k < 6; ++k) {
+        assert(results[k].error.empty() && results[k].solved == true);
+        assert(results[k].lb_makespan <= results[k].makespan);
+        assert(results[k].lb_soc <= results[k].soc);
+        assert((batch.getPlan(k) != nullptr) == (k == 2));
+    }
+    assert(results[6].solved == false && !results[6].error.empty());
+
+    // same as solving one at a time
+    MAPF_Instance* P = new MAPF_Instance(G, 2, params.max_timestep, params.max_comp_time);
+    P->make(60);
+    MAPF_Solver* mapf = make_solver(P, params);
+    mapf->solve();
+    assert(mapf->getSolution().getSOC() == results[2].soc);
+    for (int i = 0; i < P->getNum(); ++i) {
+        assert(batch.getPlan(2)->getPath(i) == mapf->getSolution().getPath(i));
+    }
+    debug("Batch solver ... [OK]", t_start);
+    delete mapf; delete P; delete G;
+}
+
+void test_portfolio() {
+    auto t_start = Time::now();
+
+    Grid* G = new Grid("assets/warehouse", true);
+    MAPF_Instance* P = new MAPF_Instance(G, 7, 10000, 5000);
+    P->make(150);
+    Parameters params;
+    params.solver = "PORTFOLIO";
+    params.portfolio_size = 3;
+    params.portfolio_mode = "soc";
+    Portfolio* portfolio = dynamic_cast<Portfolio*>(make_solver(P, params));
+    assert(portfolio != nullptr && portfolio->size() == 3);
+    assert(portfolio->getMode() == Portfolio::Mode::BEST_SOC);
+    for (int k = 0; k < portfolio->size(); ++k) assert(portfolio->getMember(k)->getDistanceTable().empty());
+    portfolio->solve();
+    assert(portfolio->succeed() == true);
+    assert(portfolio->getSolution().validate(P) == true);
+    for (int k = 0; k < portfolio->size(); ++k) {
+        const MAPF_Solver* member = portfolio->getMember(k);
+        assert(member->getSeed() == P->getSeed() + k);
+        assert(&member->getDistanceTable() == &portfolio->getDistanceTable());      // shared
+        if (member->succeed()) assert(portfolio->getSolution().getSOC() <= member->getSolution().getSOC());
+    }
+    const MAPF_Solver* best = portfolio->getMember(portfolio->getWinner());
+    assert(portfolio->getSolution().getSOC() == best->getSolution().getSOC());
+
+    delete portfolio;
+
+    // the winning plan reaches the stream of the portfolio
+    Portfolio* streaming = dynamic_cast<Portfolio*>(make_solver(P, params));
+    streaming->streamSolution("test.bplan");
+    streaming->solve();
+    assert(streaming->succeed() == true);
+    {
+        PlanReader streamed("test.bplan");
+        assert(streamed.getMakespan() == streaming->getSolution().getMakespan());
+        for (int i = 0; i < P->getNum(); ++i) {
+            assert(streamed.getPath(i) == streaming->getSolution().getPath(i));
+        }
+    }
+    std::filesystem::remove("test.bplan");
+    delete streaming;
+
+    // a stop only reaches members still running, so solving again starts clean
+    params.portfolio_mode = "first";
+    Portfolio* first = dynamic_cast<Portfolio*>(make_solver(P, params));
+    for (int round = 0; round < 2; ++round) {
+        first->solve();
+        assert(first->succeed() == true);
+        assert(first->getSolution().validate(P) == true);
+        for (int k = 0; k < first->size(); ++k) assert(first->getMember(k)->stopRequested() == false);
+    }
+    assert(first->getMember(first->getWinner())->getSolution().getMakespan() == first->getSolution().getMakespan());
+    debug("Portfolio solver ... [OK]", t_start);
+    delete first; delete P; delete G;
+}
+
+void test_capi() {
+    auto t_start = Time::now();
+
+    assert(mapf_api_version() == MAPF_C_API_VERSION);
+    assert(mapf_graph_create("assets/missing", 0) == nullptr);
+    assert(std::string(mapf_last_error()).find("not found") != std::string::npos);
+
+    mapf_graph* graph = mapf_graph_create("assets/warehouse", 1);
+    assert(mapf_graph_width(graph) == 35 && mapf_graph_height(graph) == 21);
+    mapf_instance* instance = mapf_instance_create(graph, 42, 10000, 1000);
+    int32_t starts[] = {9, 17, 3, 25, 17, 1};
+    int32_t goals[] = {17, 18, 0, 0, 0, 2};
+    int32_t invalid[] = {7, 2, 0, 0, 0, 2};     // obstacle
+    assert(mapf_instance_make(instance, starts, invalid, 2) == MAPF_ERROR);
+    assert(mapf_instance_make(instance, starts, goals, 2) == MAPF_OK);
+    assert(mapf_instance_num_agents(instance) == 2);
+    assert(mapf_solver_create(instance, "unknown") == nullptr);
+
+    mapf_solver* solver = mapf_solver_create(instance, "PIBT");
+    assert(mapf_solver_solve(solver) == MAPF_OK);
+    assert(mapf_solver_succeeded(solver) == 1);
+    int T = mapf_plan_makespan(solver) + 1;
+    std::vector<int32_t> states(T * 2 * 3);
+    assert(mapf_plan_states(solver, states.data(), states.size() - 1) == MAPF_ERROR);
+    assert(mapf_plan_states(solver, states.data(), states.size()) == MAPF_OK);
+    assert(std::equal(starts, starts + 6, states.begin()));
+    assert(mapf_plan_path_length(solver, 0) <= T && mapf_plan_path_length(solver, 2) == MAPF_ERROR);
+    mapf_solver_destroy(solver);
+    mapf_instance_destroy(instance);
+    mapf_graph_destroy(graph);
+    debug("C interface ... [OK]", t_start);
 }
 
 int main() {
@@ -313,8 +1439,18 @@ int main() {
     debug("Starting test ... ");
     test_graph();
     test_problem();
+    test_plan();
     test_solver();
     test_pibt();
+    test_lacam();
+    test_pp();
+    test_tswap();
+    test_lns();
+    test_adg();
+    test_traffic();
+    test_batch();
+    test_portfolio();
+    test_capi();
     debug("Test complete", t);
     return 0;
 }
\ No newline at end of file